@@ -43,126 +43,176 @@
 
 /////////////////////////////////////////////////
 
-static String generateEventMessage(const char *message, const char *event, uint32_t id, uint32_t reconnect)
+static size_t decimalLength(uint32_t value)
 {
-  String ev = "";
+  size_t len = 1;
+
+  while (value >= 10)
+  {
+    value /= 10;
+    len++;
+  }
+
+  return len;
+}
+
+/////////////////////////////////////////////////
+
+static uint8_t * writeDecimal(uint8_t * p, uint32_t value)
+{
+  uint8_t * end = p + decimalLength(value);
+  uint8_t * digit = end;
+
+  do
+  {
+    *--digit = '0' + (value % 10);
+    value /= 10;
+  } while (value);
+
+  return end;
+}
+
+/////////////////////////////////////////////////
+
+static inline uint8_t * writeBytes(uint8_t * p, const char * data, size_t len)
+{
+  memcpy(p, data, len);
+
+  return p + len;
+}
+
+/////////////////////////////////////////////////
+
+// Exact size of the encoded event, found in one scan of message. CR, LF and CRLF each end a data line,
+// a line break ending the message does not open an empty data line
+static size_t eventMessageLength(const char *message, const char *event, uint32_t id, uint32_t reconnect)
+{
+  // blank line ending the event
+  size_t len = 2;
 
   if (reconnect)
+    len += 7 + decimalLength(reconnect) + 2;     // "retry: " N "\r\n"
+
+  if (id)
+    len += 4 + decimalLength(id) + 2;            // "id: " N "\r\n"
+
+  if (event != NULL)
+    len += 7 + strlen(event) + 2;                // "event: " E "\r\n"
+
+  if (message != NULL)
   {
-    ev += "retry: ";
-    ev += String(reconnect);
-    ev += "\r\n";
+    size_t lines = 1;
+    const char * p = message;
+
+    for (; *p; p++)
+    {
+      if (*p == '\r' || *p == '\n')
+      {
+        if (*p == '\r' && p[1] == '\n')
+          p++;
+
+        if (p[1])
+          lines++;
+      }
+      else
+      {
+        len++;
+      }
+    }
+
+    len += lines * (6 + 2);                     // "data: " line "\r\n"
+  }
+
+  return len;
+}
+
+/////////////////////////////////////////////////
+
+// Writes the event into buf, which must hold eventMessageLength() bytes. Line runs are copied with memcpy
+static size_t encodeEventMessage(uint8_t *buf, const char *message, const char *event, uint32_t id, uint32_t reconnect)
+{
+  uint8_t * p = buf;
+
+  if (reconnect)
+  {
+    p = writeBytes(p, "retry: ", 7);
+    p = writeDecimal(p, reconnect);
+    p = writeBytes(p, "\r\n", 2);
   }
 
   if (id)
   {
-    ev += "id: ";
-    ev += String(id);
-    ev += "\r\n";
+    p = writeBytes(p, "id: ", 4);
+    p = writeDecimal(p, id);
+    p = writeBytes(p, "\r\n", 2);
   }
 
   if (event != NULL)
   {
-    ev += "event: ";
-    ev += String(event);
-    ev += "\r\n";
+    p = writeBytes(p, "event: ", 7);
+    p = writeBytes(p, event, strlen(event));
+    p = writeBytes(p, "\r\n", 2);
   }
 
   if (message != NULL)
   {
-    size_t messageLen = strlen(message);
-    char * lineStart = (char *)message;
-    char * lineEnd;
+    const char * line = message;
 
-    do
+    while (true)
     {
-      char * nextN = strchr(lineStart, '\n');
-      char * nextR = strchr(lineStart, '\r');
+      const char * lineEnd = line;
 
-      if (nextN == NULL && nextR == NULL)
-      {
-        size_t llen = ((char *)message + messageLen) - lineStart;
-        char * ldata = (char *)malloc(llen + 1);
-
-        if (ldata != NULL)
-        {
-          memcpy(ldata, lineStart, llen);
-          ldata[llen] = 0;
-          ev += "data: ";
-          ev += ldata;
-          ev += "\r\n\r\n";
-          free(ldata);
-        }
-
-        lineStart = (char *)message + messageLen;
-      }
-      else
-      {
-        char * nextLine = NULL;
-
-        if (nextN != NULL && nextR != NULL)
-        {
-          if (nextR < nextN)
-          {
-            lineEnd = nextR;
-
-            if (nextN == (nextR + 1))
-              nextLine = nextN + 1;
-            else
-              nextLine = nextR + 1;
-          }
-          else
-          {
-            lineEnd = nextN;
-
-            if (nextR == (nextN + 1))
-              nextLine = nextR + 1;
-            else
-              nextLine = nextN + 1;
-          }
-        }
-        else if (nextN != NULL)
-        {
-          lineEnd = nextN;
-          nextLine = nextN + 1;
-        }
-        else
-        {
-          lineEnd = nextR;
-          nextLine = nextR + 1;
-        }
-
-        size_t llen = lineEnd - lineStart;
-        char * ldata = (char *)malloc(llen + 1);
-
-        if (ldata != NULL)
-        {
-          memcpy(ldata, lineStart, llen);
-          ldata[llen] = 0;
-          ev += "data: ";
-          ev += ldata;
-          ev += "\r\n";
-          free(ldata);
-        }
-
-        lineStart = nextLine;
-
-        if (lineStart == ((char *)message + messageLen))
-          ev += "\r\n";
-      }
-    } while (lineStart < ((char *)message + messageLen));
+      while (*lineEnd && *lineEnd != '\r' && *lineEnd != '\n')
+        lineEnd++;
+
+      p = writeBytes(p, "data: ", 6);
+      p = writeBytes(p, line, lineEnd - line);
+      p = writeBytes(p, "\r\n", 2);
+
+      if (*lineEnd == 0)
+        break;
+
+      if (lineEnd[0] == '\r' && lineEnd[1] == '\n')
+        lineEnd++;
+
+      line = lineEnd + 1;
+
+      if (*line == 0)
+        break;
+    }
   }
 
-  return ev;
+  p = writeBytes(p, "\r\n", 2);
+
+  return p - buf;
+}
+
+/////////////////////////////////////////////////
+
+// FNV-1a of the event name, used as coalescing key
+static uint32_t eventKey(const char *event)
+{
+  if (event == NULL)
+    return 0;
+
+  uint32_t hash = 2166136261UL;
+
+  while (*event)
+  {
+    hash ^= (uint8_t) *event++;
+    hash *= 16777619UL;
+  }
+
+  return hash ? hash : 1;
 }
 
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
-// Message
+// Buffer
 
-AsyncEventSourceMessage::AsyncEventSourceMessage(const char * data, size_t len)
-  : _data(nullptr), _len(len), _sent(0), _acked(0)
+AsyncEventSourceBuffer::AsyncEventSourceBuffer(const char * data, size_t len)
+  : _data(nullptr), _len(len), _count(0)
 {
   _data = (uint8_t*)malloc(_len + 1);
 
@@ -179,12 +229,65 @@ AsyncEventSourceMessage::AsyncEventSourceMessage(const char * data, size_t len)
 
 /////////////////////////////////////////////////
 
-AsyncEventSourceMessage::~AsyncEventSourceMessage()
+// Encodes the event straight into the buffer
+AsyncEventSourceBuffer::AsyncEventSourceBuffer(const char *message, const char *event, uint32_t id,
+                                               uint32_t reconnect)
+  : _data(nullptr), _len(eventMessageLength(message, event, id, reconnect)), _count(0)
+{
+  _data = (uint8_t*)malloc(_len + 1);
+
+  if (_data == nullptr)
+  {
+    _len = 0;
+  }
+  else
+  {
+    encodeEventMessage(_data, message, event, id, reconnect);
+    _data[_len] = 0;
+  }
+}
+
+/////////////////////////////////////////////////
+
+AsyncEventSourceBuffer::~AsyncEventSourceBuffer()
 {
   if (_data != NULL)
     free(_data);
 }
 
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+// Message
+
+AsyncEventSourceMessage::AsyncEventSourceMessage(const char * data, size_t len, uint32_t key)
+  : AsyncEventSourceMessage(new AsyncEventSourceBuffer(data, len), key)
+{
+}
+
+/////////////////////////////////////////////////
+
+AsyncEventSourceMessage::AsyncEventSourceMessage(const char *message, const char *event, uint32_t id,
+                                                 uint32_t reconnect)
+  : AsyncEventSourceMessage(new AsyncEventSourceBuffer(message, event, id, reconnect), eventKey(event))
+{
+}
+
+/////////////////////////////////////////////////
+
+AsyncEventSourceMessage::AsyncEventSourceMessage(AsyncEventSourceBuffer * buffer, uint32_t key)
+  : _buffer(buffer), _len(buffer->length()), _sent(0), _acked(0), _key(key)
+{
+  _buffer->retain();
+}
+
+/////////////////////////////////////////////////
+
+AsyncEventSourceMessage::~AsyncEventSourceMessage()
+{
+  _buffer->release();
+}
+
 /////////////////////////////////////////////////
 
 size_t AsyncEventSourceMessage::ack(size_t len, uint32_t time)
@@ -208,19 +311,19 @@ size_t AsyncEventSourceMessage::ack(size_t len, uint32_t time)
 
 /////////////////////////////////////////////////
 
+// Adds as much of the event as the socket takes. Flushed by AsyncEventSourceClient::_runQueue()
 size_t AsyncEventSourceMessage::send(AsyncClient *client)
 {
-  const size_t len = _len - _sent;
+  size_t len = _len - _sent;
+  size_t space = client->space();
 
-  if (client->space() < len)
-  {
-    return 0;
-  }
+  if (space < len)
+    len = space;
 
-  size_t sent = client->add((const char *)_data, len);
+  if (len == 0)
+    return 0;
 
-  if (client->canSend())
-    client->send();
+  size_t sent = client->add((const char *)_buffer->data() + _sent, len);
 
   _sent += sent;
 
@@ -237,13 +340,28 @@ AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest *request, A
 {
   delete  m;
 }))
+, _timer([](void *r)
+{
+  ((AsyncEventSourceClient*)(r))->_onTimer();
+}, this)
 {
   _client = request->client();
   _server = server;
+  _resumed = false;
+  _timers = &request->server()->timers();
+  _heartbeat = _server->heartbeat() * 1000;
+  _lastWriteTime = millis();
   _lastId = 0;
+  _queuePolicy = _server->queuePolicy();
+  _queueLimit = _server->queueLimit();
+  _queuedBytes = 0;
+  memset(&_queueStats, 0, sizeof(_queueStats));
+  _closePending = false;
+  _inFlight = 0;
+  _corked = false;
 
-  if (request->hasHeader("Last-Event-ID"))
-    _lastId = atoi(request->getHeader("Last-Event-ID")->value().c_str());
+  if (request->hasHeader(AWS_HDR_LAST_EVENT_ID))
+    _lastId = atoi(request->getHeader(AWS_HDR_LAST_EVENT_ID)->value().c_str());
 
   _client->setRxTimeout(0);
   _client->onError(NULL, NULL);
@@ -275,6 +393,9 @@ AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest *request, A
 
   _server->_addClient(this);
 
+  if (_heartbeat)
+    _armTimer();
+
   delete request;
 }
 
@@ -288,29 +409,111 @@ AsyncEventSourceClient::~AsyncEventSourceClient()
 
 /////////////////////////////////////////////////
 
+void AsyncEventSourceClient::_removeMessage(AsyncEventSourceMessage *dataMessage)
+{
+  _queuedBytes -= dataMessage->length();
+  _messageQueue.remove(dataMessage);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncEventSourceClient::_queueOverLimit(size_t len)
+{
+  // An empty queue always accepts, so an event larger than the limit can still be sent
+  if (_messageQueue.isEmpty())
+    return false;
+
+  return ((_queuedBytes + len) > _queueLimit) || (_messageQueue.length() >= SSE_MAX_QUEUED_MESSAGES);
+}
+
+/////////////////////////////////////////////////
+
+// Drops the oldest message that has not been handed to the TCP stack yet
+bool AsyncEventSourceClient::_dropOldestMessage()
+{
+  for (const auto& m : _messageQueue)
+  {
+    if (!m->started())
+    {
+      _removeMessage(m);
+      _queueStats.droppedOldest++;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
 void AsyncEventSourceClient::_queueMessage(AsyncEventSourceMessage *dataMessage)
 {
   if (dataMessage == NULL)
     return;
 
-  if (!connected())
+  if (!connected() || _closePending)
   {
     delete dataMessage;
 
     return;
   }
 
-  if (_messageQueue.length() >= SSE_MAX_QUEUED_MESSAGES)
+  const size_t len = dataMessage->length();
+
+  if ( (_queuePolicy == AWS_QUEUE_COALESCE) && dataMessage->key() )
   {
-    AWS_LOGERROR(F("[AsyncEventSourceClient::_queueMessage] ERROR: Too many messages queued"));
+    for (const auto& m : _messageQueue)
+    {
+      if ( (m->key() == dataMessage->key()) && !m->started() )
+      {
+        _removeMessage(m);
+        _queueStats.coalesced++;
 
-    delete dataMessage;
+        break;
+      }
+    }
   }
-  else
+
+  if (_queueOverLimit(len))
   {
-    _messageQueue.add(dataMessage);
+    if (_queuePolicy == AWS_QUEUE_DISCONNECT)
+    {
+      AWS_LOGERROR(F("[AsyncEventSourceClient::_queueMessage] Slow consumer, closing"));
+
+      delete dataMessage;
+      _queueStats.disconnects++;
+
+      // Closed from _onPoll(), as closing here could delete this client while the server iterates its list
+      _closePending = true;
+
+      return;
+    }
+
+    if (_queuePolicy != AWS_QUEUE_DROP_NEWEST)
+    {
+      while (_queueOverLimit(len) && _dropOldestMessage());
+    }
+
+    if (_queueOverLimit(len) && (_queuePolicy == AWS_QUEUE_DROP_NEWEST || _messageQueue.length() >= SSE_MAX_QUEUED_MESSAGES))
+    {
+      AWS_LOGERROR(F("[AsyncEventSourceClient::_queueMessage] ERROR: Too many messages queued"));
+
+      delete dataMessage;
+      _queueStats.droppedNewest++;
+
+      return;
+    }
   }
 
+  _messageQueue.add(dataMessage);
+  _queuedBytes += len;
+  _queueStats.queued++;
+  _lastWriteTime = millis();
+
+  if (_queuedBytes > _queueStats.maxQueuedBytes)
+    _queueStats.maxQueuedBytes = _queuedBytes;
+
   if (_client->canSend())
     _runQueue();
 }
@@ -319,25 +522,66 @@ void AsyncEventSourceClient::_queueMessage(AsyncEventSourceMessage *dataMessage)
 
 void AsyncEventSourceClient::_onAck(size_t len, uint32_t time)
 {
+  _inFlight -= (len < _inFlight) ? len : _inFlight;
+
   while (len && !_messageQueue.isEmpty())
   {
     len = _messageQueue.front()->ack(len, time);
 
     if (_messageQueue.front()->finished())
-      _messageQueue.remove(_messageQueue.front());
+      _removeMessage(_messageQueue.front());
   }
 
   _runQueue();
+
+  // Deliver events other tasks posted meanwhile
+  _server->_drainPosts();
 }
 
 /////////////////////////////////////////////////
 
 void AsyncEventSourceClient::_onPoll()
 {
+  if (_closePending)
+  {
+    close();
+
+    return;
+  }
+
   if (!_messageQueue.isEmpty())
   {
     _runQueue();
   }
+
+  // Last, expiring timers may close this client
+  _timers->poll();
+}
+
+/////////////////////////////////////////////////
+
+// Queuing an event only records the time, the timer re-checks it when it fires
+void AsyncEventSourceClient::_armTimer()
+{
+  uint32_t idle = millis() - _lastWriteTime;
+
+  _timers->schedule(_timer, (idle < _heartbeat) ? (_heartbeat - idle) : _heartbeat);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSourceClient::_onTimer()
+{
+  if (!connected())
+    return;
+
+  if ((millis() - _lastWriteTime) >= _heartbeat && _messageQueue.isEmpty())
+  {
+    // SSE comment line, ignored by the browser
+    write(":\n\n", 3);
+  }
+
+  _armTimer();
 }
 
 /////////////////////////////////////////////////
@@ -365,17 +609,23 @@ void AsyncEventSourceClient::close()
 
 /////////////////////////////////////////////////
 
-void AsyncEventSourceClient::write(const char * message, size_t len)
+void AsyncEventSourceClient::write(const char * message, size_t len, uint32_t key)
 {
-  _queueMessage(new AsyncEventSourceMessage(message, len));
+  _queueMessage(new AsyncEventSourceMessage(message, len, key));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSourceClient::write(AsyncEventSourceBuffer * buffer, uint32_t key)
+{
+  _queueMessage(new AsyncEventSourceMessage(buffer, key));
 }
 
 /////////////////////////////////////////////////
 
 void AsyncEventSourceClient::send(const char *message, const char *event, uint32_t id, uint32_t reconnect)
 {
-  String ev = generateEventMessage(message, event, id, reconnect);
-  _queueMessage(new AsyncEventSourceMessage(ev.c_str(), ev.length()));
+  _queueMessage(new AsyncEventSourceMessage(message, event, id, reconnect));
 }
 
 /////////////////////////////////////////////////
@@ -384,16 +634,63 @@ void AsyncEventSourceClient::_runQueue()
 {
   while (!_messageQueue.isEmpty() && _messageQueue.front()->finished())
   {
-    _messageQueue.remove(_messageQueue.front());
+    _removeMessage(_messageQueue.front());
+  }
+
+  if (_corked || _server->corked() || _client == NULL || !_client->canSend())
+    return;
+
+  // While earlier data is unacknowledged, small events wait for the ACK (or a full segment's worth)
+  // and then leave together
+  if (_inFlight)
+  {
+    size_t waiting = 0;
+
+    for (const auto& m : _messageQueue)
+      waiting += m->unsent();
+
+    if (waiting < SSE_FLUSH_BYTES)
+      return;
+  }
+
+  size_t added = 0;
+
+  for (const auto& m : _messageQueue)
+  {
+    if (m->sent())
+      continue;
+
+    added += m->send(_client);
+
+    // Socket full, the rest follows in order
+    if (!m->sent())
+      break;
   }
 
-  for (auto i = _messageQueue.begin(); i != _messageQueue.end(); ++i)
+  if (added)
   {
-    if (!(*i)->sent())
-      (*i)->send(_client);
+    _inFlight += added;
+    _client->send();
   }
 }
 
+/////////////////////////////////////////////////
+
+void AsyncEventSourceClient::cork()
+{
+  _corked = true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSourceClient::uncork()
+{
+  _corked = false;
+
+  if (!_messageQueue.isEmpty())
+    _runQueue();
+}
+
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
@@ -406,6 +703,24 @@ AsyncEventSource::AsyncEventSource(const String& url)
   delete c;
 }))
 , _connectcb(NULL)
+, _queuePolicy(AWS_QUEUE_DROP_NEWEST)
+, _queueLimit(SSE_MAX_QUEUED_BYTES)
+, _heartbeat(0)
+, _corked(false)
+, _replay(NULL)
+, _replaySlots(0)
+, _replayHead(0)
+, _replayCount(0)
+, _replayBytes(0)
+, _replayLimit(0)
+, _posted(SSE_MAX_POSTED_EVENTS)
+, _liveClients(0)
+, _replayEnabled(false)
+, _drainTimer([](void *r)
+{
+  ((AsyncEventSource*)(r))->_onDrainTimer();
+}, this)
+, _timers(NULL)
 {}
 
 /////////////////////////////////////////////////
@@ -413,6 +728,136 @@ AsyncEventSource::AsyncEventSource(const String& url)
 AsyncEventSource::~AsyncEventSource()
 {
   close();
+  setReplayBuffer(0);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSource::uncork()
+{
+  _corked = false;
+
+  for (const auto &c : _clients)
+  {
+    if (c->connected())
+      c->uncork();
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncEventSource::setReplayBuffer(uint16_t maxEvents, size_t maxBytes)
+{
+  AsyncWebLockGuard l(_replayLock);
+
+  _clearReplay();
+
+  if (_replay)
+  {
+    free(_replay);
+    _replay = NULL;
+  }
+
+  _replaySlots = 0;
+  _replayLimit = 0;
+  _replayEnabled.store(false);
+
+  if (maxEvents == 0)
+    return true;
+
+  _replay = (AsyncEventSourceReplayEntry *) malloc(maxEvents * sizeof(AsyncEventSourceReplayEntry));
+
+  if (_replay == NULL)
+  {
+    AWS_LOGERROR(F("[AsyncEventSource::setReplayBuffer] Error malloc replay ring"));
+
+    return false;
+  }
+
+  _replaySlots = maxEvents;
+  _replayLimit = maxBytes;
+  _replayEnabled.store(true);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSource::_clearReplay()
+{
+  while (_replayCount)
+  {
+    _replay[_replayHead].buffer->release();
+    _replayHead = (_replayHead + 1) % _replaySlots;
+    _replayCount--;
+  }
+
+  _replayHead = 0;
+  _replayBytes = 0;
+}
+
+/////////////////////////////////////////////////
+
+// Called with _replayLock held
+void AsyncEventSource::_recordEvent(AsyncEventSourceBuffer * buffer, uint32_t id, uint32_t key)
+{
+  if (_replaySlots == 0)
+    return;
+
+  size_t len = buffer->length();
+
+  if (len > _replayLimit)
+  {
+    // Can't be replayed, so no older id may resume across it
+    _clearReplay();
+
+    return;
+  }
+
+  while (_replayCount && ((_replayCount == _replaySlots) || ((_replayBytes + len) > _replayLimit)))
+  {
+    _replayBytes -= _replay[_replayHead].buffer->length();
+    _replay[_replayHead].buffer->release();
+    _replayHead = (_replayHead + 1) % _replaySlots;
+    _replayCount--;
+  }
+
+  AsyncEventSourceReplayEntry &entry = _replay[(_replayHead + _replayCount) % _replaySlots];
+
+  entry.id = id;
+  entry.key = key;
+  entry.buffer = buffer;
+
+  buffer->retain();
+  _replayBytes += len;
+  _replayCount++;
+}
+
+/////////////////////////////////////////////////
+
+// Called with _replayLock held. Queues the events after the client's Last-Event-ID, if it is still in the ring
+bool AsyncEventSource::_replayTo(AsyncEventSourceClient * client)
+{
+  if (!_replayCount || !client->lastId())
+    return false;
+
+  uint16_t i = _replayCount;
+
+  // Newest first, the id most likely to match
+  while (i > 0 && _replay[(_replayHead + i - 1) % _replaySlots].id != client->lastId())
+    i--;
+
+  if (i == 0)
+    return false;
+
+  for (; i < _replayCount; i++)
+  {
+    const AsyncEventSourceReplayEntry &entry = _replay[(_replayHead + i) % _replaySlots];
+
+    client->write(entry.buffer, entry.key);
+  }
+
+  return true;
 }
 
 /////////////////////////////////////////////////
@@ -439,7 +884,24 @@ void AsyncEventSource::_addClient(AsyncEventSourceClient * client)
     free(temp);
     }*/
 
-  _clients.add(client);
+  // Posted before it joined : into the replay ring, and to the clients already there
+  _drainPosts();
+
+  {
+    // Replay and join under the lock, so an event sent meanwhile is neither missed nor duplicated
+    AsyncWebLockGuard l(_replayLock);
+
+    client->_resumed = _replayTo(client);
+    _clients.add(client);
+  }
+
+  _liveClients.fetch_add(1);
+
+  if (!_drainTimer.armed())
+  {
+    _timers = client->_timers;
+    _timers->schedule(_drainTimer, AWS_TIMER_TICK_MS);
+  }
 
   if (_connectcb)
     _connectcb(client);
@@ -449,7 +911,31 @@ void AsyncEventSource::_addClient(AsyncEventSourceClient * client)
 
 void AsyncEventSource::_handleDisconnect(AsyncEventSourceClient * client)
 {
-  _clients.remove(client);
+  {
+    // _broadcast() walks the list under the same lock
+    AsyncWebLockGuard l(_replayLock);
+
+    _clients.remove(client);
+  }
+
+  // Last one gone : what is still queued only goes to the replay ring, which keeps the timer going
+  if (_liveClients.fetch_sub(1) == 1)
+  {
+    _drainPosts();
+
+    if (!_replayEnabled.load())
+      _drainTimer.cancel();
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSource::_onDrainTimer()
+{
+  _drainPosts();
+
+  if (_liveClients.load() || _replayEnabled.load())
+    _timers->schedule(_drainTimer, AWS_TIMER_TICK_MS);
 }
 
 /////////////////////////////////////////////////
@@ -491,19 +977,99 @@ size_t AsyncEventSource::avgPacketsWaiting() const
 
 void AsyncEventSource::send(const char *message, const char *event, uint32_t id, uint32_t reconnect)
 {
-  String ev = generateEventMessage(message, event, id, reconnect);
+  if (_clients.isEmpty() && !(id && _replaySlots))
+    return;
+
+  // Encoded once, every client's message and the replay ring reference the same buffer
+  AsyncEventSourceBuffer * buffer = new AsyncEventSourceBuffer(message, event, id, reconnect);
+
+  if (buffer->length() == 0)
+  {
+    AWS_LOGERROR(F("[AsyncEventSource::send] Error malloc event"));
+
+    delete buffer;
+
+    return;
+  }
+
+  buffer->retain();
+  _broadcast(buffer, id, eventKey(event));
+  buffer->release();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncEventSource::_broadcast(AsyncEventSourceBuffer * buffer, uint32_t id, uint32_t key)
+{
+  AsyncWebLockGuard l(_replayLock);
+
+  if (id && _replaySlots)
+    _recordEvent(buffer, id, key);
 
   for (const auto &c : _clients)
   {
     if (c->connected())
     {
-      c->write(ev.c_str(), ev.length());
+      c->write(buffer, key);
     }
   }
 }
 
 /////////////////////////////////////////////////
 
+// Runs on the posting task: only encodes and pushes, the client list is left to the AsyncTCP task
+bool AsyncEventSource::post(const char *message, const char *event, uint32_t id, uint32_t reconnect)
+{
+  AsyncEventSourceBuffer * buffer = new AsyncEventSourceBuffer(message, event, id, reconnect);
+
+  if (buffer->length() == 0)
+  {
+    AWS_LOGERROR(F("[AsyncEventSource::post] Error malloc event"));
+
+    delete buffer;
+
+    return false;
+  }
+
+  // Nobody to deliver to, and nothing for a client resuming later : dropped here. Recording into the replay ring
+  // is left to the AsyncTCP task, the posting task never takes _replayLock
+  if (!_liveClients.load() && !(id && _replayEnabled.load()))
+  {
+    delete buffer;
+
+    return false;
+  }
+
+  if (!_posted.push(new AsyncEventSourcePost(buffer, id, eventKey(event))))
+  {
+    AWS_LOGDEBUG1("AsyncEventSource::post: queue full, depth =", _posted.depth());
+
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// AsyncTCP task only : from the drain timer, the clients' acks, and as clients join and leave.
+// Without clients, events only reach the replay ring and are freed
+void AsyncEventSource::_drainPosts()
+{
+  AsyncWebMpscNode * node;
+
+  while ((node = _posted.pop()) != nullptr)
+  {
+    AsyncEventSourcePost * post = static_cast<AsyncEventSourcePost *>(node);
+
+    _broadcast(post->_buffer, post->_id, post->_key);
+
+    delete post;
+  }
+}
+
+/////////////////////////////////////////////////
+
 size_t AsyncEventSource::count() const
 {
   return _clients.count_if([](AsyncEventSourceClient * c)
@@ -521,7 +1087,7 @@ bool AsyncEventSource::canHandle(AsyncWebServerRequest *request)
     return false;
   }
 
-  request->addInterestingHeader("Last-Event-ID");
+  request->addInterestingHeader(AWS_HDR_LAST_EVENT_ID);
 
   return true;
 }
@@ -530,8 +1096,8 @@ bool AsyncEventSource::canHandle(AsyncWebServerRequest *request)
 
 void AsyncEventSource::handleRequest(AsyncWebServerRequest *request)
 {
-  if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
-    return request->requestAuthentication();
+  if (!_authorized(request))
+    return _requestAuthorization(request);
 
   request->send(new AsyncEventSourceResponse(this));
 }
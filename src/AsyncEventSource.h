@@ -46,9 +46,33 @@
 #include <AsyncTCP.h>
 #define SSE_MAX_QUEUED_MESSAGES 32
 
+// Default per-client send queue limit, see AwsQueuePolicy
+#ifndef SSE_MAX_QUEUED_BYTES
+  #define SSE_MAX_QUEUED_BYTES    8192
+#endif
+
+// Unsent bytes that justify a new segment while earlier data is still unacknowledged (ESP32 lwIP TCP_MSS)
+#ifndef SSE_FLUSH_BYTES
+  #define SSE_FLUSH_BYTES         1436
+#endif
+
+// Events from other tasks waiting for the AsyncTCP task, see AsyncEventSource::post()
+#ifndef SSE_MAX_POSTED_EVENTS
+  #define SSE_MAX_POSTED_EVENTS   32
+#endif
+
+// Default byte budget of the Last-Event-ID replay ring, see AsyncEventSource::setReplayBuffer()
+#ifndef SSE_REPLAY_BYTES
+  #define SSE_REPLAY_BYTES        4096
+#endif
+
 #include "AsyncWebServer_WT32_ETH01.h"
 
 #include "AsyncWebSynchronization.h"
+#include "AsyncWebQueuePolicy.h"
+#include "AsyncWebMpscQueue.h"
+
+#include <atomic>
 
 /////////////////////////////////////////////////
 
@@ -64,16 +88,68 @@ typedef std::function<void(AsyncEventSourceClient *client)> ArEventHandlerFuncti
 
 /////////////////////////////////////////////////
 
-class AsyncEventSourceMessage
+// Immutable encoded event, shared by the messages of every client it is sent to.
+// Starts unreferenced, and frees itself when the last message holding it is gone
+class AsyncEventSourceBuffer
 {
   private:
     uint8_t * _data;
     size_t _len;
+    std::atomic<uint32_t> _count;
+
+  public:
+    AsyncEventSourceBuffer(const char * data, size_t len);
+    AsyncEventSourceBuffer(const char *message, const char *event, uint32_t id, uint32_t reconnect);
+    ~AsyncEventSourceBuffer();
+
+    /////////////////////////////////////////////////
+
+    inline void retain()
+    {
+      _count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void release()
+    {
+      if (_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        delete this;
+      }
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const uint8_t * data() const
+    {
+      return _data;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t length() const
+    {
+      return _len;
+    }
+};
+
+/////////////////////////////////////////////////
+
+// One client's progress through a shared AsyncEventSourceBuffer
+class AsyncEventSourceMessage
+{
+  private:
+    AsyncEventSourceBuffer * _buffer;
+    size_t _len;
     size_t _sent;
     size_t _acked;
+    uint32_t _key;
 
   public:
-    AsyncEventSourceMessage(const char * data, size_t len);
+    AsyncEventSourceMessage(const char * data, size_t len, uint32_t key = 0);
+    AsyncEventSourceMessage(const char *message, const char *event, uint32_t id, uint32_t reconnect);
+    AsyncEventSourceMessage(AsyncEventSourceBuffer * buffer, uint32_t key = 0);
     ~AsyncEventSourceMessage();
     size_t ack(size_t len, uint32_t time __attribute__((unused)));
     size_t send(AsyncClient *client);
@@ -91,19 +167,71 @@ class AsyncEventSourceMessage
     {
       return _sent == _len;
     }
+
+    /////////////////////////////////////////////////
+
+    // true once part of the event is on the wire, so it can no longer be dropped
+    inline bool started() const
+    {
+      return _sent > 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t unsent() const
+    {
+      return _len - _sent;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t length() const
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Messages with the same non-zero key replace each other under AWS_QUEUE_COALESCE
+    inline uint32_t key() const
+    {
+      return _key;
+    }
 };
 
 /////////////////////////////////////////////////
 
 class AsyncEventSourceClient
 {
+    friend AsyncEventSource;
+
   private:
     AsyncClient *_client;
     AsyncEventSource *_server;
     uint32_t _lastId;
+    bool _resumed;
     LinkedList<AsyncEventSourceMessage *> _messageQueue;
+
+    AwsQueuePolicy _queuePolicy;
+    size_t _queueLimit;
+    size_t _queuedBytes;
+    AwsQueueStats _queueStats;
+    bool _closePending;
+    size_t _inFlight;
+    bool _corked;
+
+    uint32_t _heartbeat;
+    uint32_t _lastWriteTime;
+    AsyncWebTimerWheel * _timers;
+    AsyncWebTimer _timer;
+
+    bool _queueOverLimit(size_t len);
+    bool _dropOldestMessage();
+    void _removeMessage(AsyncEventSourceMessage *dataMessage);
     void _queueMessage(AsyncEventSourceMessage *dataMessage);
     void _runQueue();
+    void _armTimer();
+    void _onTimer();
 
   public:
 
@@ -120,11 +248,57 @@ class AsyncEventSourceClient
     /////////////////////////////////////////////////
 
     void close();
-    void write(const char * message, size_t len);
+
+    //hold events in the queue until uncork(), which sends them in as few segments as possible
+    void cork();
+    void uncork();
+
+    /////////////////////////////////////////////////
+
+    inline bool corked() const
+    {
+      return _corked;
+    }
+
+    /////////////////////////////////////////////////
+
+    void write(const char * message, size_t len, uint32_t key = 0);
+    void write(AsyncEventSourceBuffer * buffer, uint32_t key = 0);
     void send(const char *message, const char *event = NULL, uint32_t id = 0, uint32_t reconnect = 0);
 
     /////////////////////////////////////////////////
 
+    //send queue backpressure, maxBytes is the queue limit in bytes.
+    //AWS_QUEUE_COALESCE keeps only the latest queued message per event name
+    inline void setQueuePolicy(AwsQueuePolicy policy, size_t maxBytes = SSE_MAX_QUEUED_BYTES)
+    {
+      _queuePolicy = policy;
+      _queueLimit = maxBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsQueuePolicy queuePolicy() const
+    {
+      return _queuePolicy;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t queuedBytes() const
+    {
+      return _queuedBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const AwsQueueStats& queueStats() const
+    {
+      return _queueStats;
+    }
+
+    /////////////////////////////////////////////////
+
     inline bool connected() const
     {
       return (_client != NULL) && _client->connected();
@@ -139,6 +313,14 @@ class AsyncEventSourceClient
 
     /////////////////////////////////////////////////
 
+    //true if the events missed since Last-Event-ID were replayed, so no full state refresh is needed
+    inline bool resumed() const
+    {
+      return _resumed;
+    }
+
+    /////////////////////////////////////////////////
+
     inline size_t  packetsWaiting() const
     {
       return _messageQueue.length();
@@ -155,12 +337,81 @@ class AsyncEventSourceClient
 
 /////////////////////////////////////////////////
 
+// Event posted from another task by AsyncEventSource::post(), already encoded by the posting task
+class AsyncEventSourcePost : public AsyncWebMpscNode
+{
+  public:
+    AsyncEventSourceBuffer * _buffer;
+    uint32_t _id;
+    uint32_t _key;
+
+    AsyncEventSourcePost(AsyncEventSourceBuffer * buffer, uint32_t id, uint32_t key)
+      : _buffer(buffer), _id(id), _key(key)
+    {
+      _buffer->retain();
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual ~AsyncEventSourcePost() override
+    {
+      _buffer->release();
+    }
+};
+
+/////////////////////////////////////////////////
+
 class AsyncEventSource: public AsyncWebHandler
 {
   private:
     String _url;
     LinkedList<AsyncEventSourceClient *> _clients;
     ArEventHandlerFunction _connectcb;
+    AwsQueuePolicy _queuePolicy;
+    size_t _queueLimit;
+    uint32_t _heartbeat;
+    bool _corked;
+
+    typedef struct
+    {
+      uint32_t id;
+      uint32_t key;
+      AsyncEventSourceBuffer * buffer;
+    } AsyncEventSourceReplayEntry;
+
+    // Ring of the last events sent with an id, oldest at _replayHead
+    AsyncEventSourceReplayEntry * _replay;
+    uint16_t _replaySlots;
+    uint16_t _replayHead;
+    uint16_t _replayCount;
+    size_t _replayBytes;
+    size_t _replayLimit;
+    AsyncWebLock _replayLock;
+
+    void _clearReplay();
+    void _recordEvent(AsyncEventSourceBuffer * buffer, uint32_t id, uint32_t key);
+    bool _replayTo(AsyncEventSourceClient * client);
+
+    AsyncWebMpscQueue _posted;
+
+    // Read by the posting tasks : with no client and no replay ring, nothing would use a post, so it is dropped
+    std::atomic<uint32_t> _liveClients;
+    std::atomic<bool> _replayEnabled;
+
+    // Drains _posted every tick while clients are connected or the replay ring records, whichever connection
+    // advances the wheel. Armed from the first client on
+    AsyncWebTimer _drainTimer;
+    AsyncWebTimerWheel * _timers;
+
+    void _onDrainTimer();
+    void _broadcast(AsyncEventSourceBuffer * buffer, uint32_t id, uint32_t key);
+
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return _url;
+    }
 
   public:
     AsyncEventSource(const String& url);
@@ -175,15 +426,122 @@ class AsyncEventSource: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    /////////////////////////////////////////////////
+
+    //backpressure policy applied to clients connecting from now on
+    inline void setQueuePolicy(AwsQueuePolicy policy, size_t maxBytes = SSE_MAX_QUEUED_BYTES)
+    {
+      _queuePolicy = policy;
+      _queueLimit = maxBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsQueuePolicy queuePolicy() const
+    {
+      return _queuePolicy;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t queueLimit() const
+    {
+      return _queueLimit;
+    }
+
+    /////////////////////////////////////////////////
+
+    //send a comment line to clients idle for seconds, keeping proxies from closing the stream
+    //and detecting dead peers. disabled if zero (default). Applies to clients connecting from now on
+    inline void setHeartbeat(uint16_t seconds)
+    {
+      _heartbeat = seconds * 1000;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint16_t heartbeat() const
+    {
+      return (uint16_t)(_heartbeat / 1000);
+    }
+
+    /////////////////////////////////////////////////
+
+    //cork all clients, e.g. around a burst of send() calls. uncork() also uncorks every client
+    inline void cork()
+    {
+      _corked = true;
+    }
+
+    /////////////////////////////////////////////////
+
+    void uncork();
+
+    /////////////////////////////////////////////////
+
+    inline bool corked() const
+    {
+      return _corked;
+    }
+
+    /////////////////////////////////////////////////
+
+    //keep up to maxEvents / maxBytes of the latest events sent with an id, and replay the ones
+    //after Last-Event-ID to reconnecting clients. maxEvents = 0 disables it (default)
+    bool setReplayBuffer(uint16_t maxEvents, size_t maxBytes = SSE_REPLAY_BYTES);
+
+    /////////////////////////////////////////////////
+
+    inline size_t replayBytes() const
+    {
+      return _replayBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    //contention of the lock guarding the client list and replay ring, needs AWS_LOCK_STATS
+    inline AwsLockStats lockStats() const
+    {
+      return _replayLock.stats();
+    }
+
+    /////////////////////////////////////////////////
+
     void close();
     void onConnect(ArEventHandlerFunction cb);
     void send(const char *message, const char *event = NULL, uint32_t id = 0, uint32_t reconnect = 0);
+
+    //cross-task send, safe to call from any task or core. The event is encoded here and pushed on a
+    //lock-free queue that the AsyncTCP task drains every timer tick (AWS_TIMER_TICK_MS) or on a client's ack,
+    //so the caller never takes a lock or touches the client list. With no client connected, only an event with
+    //an id is queued, for the replay buffer. Returns false if the queue is full or the event would go nowhere
+    bool post(const char *message, const char *event = NULL, uint32_t id = 0, uint32_t reconnect = 0);
+
+    /////////////////////////////////////////////////
+
+    //events posted and waiting for the AsyncTCP task
+    inline uint32_t postQueueDepth() const
+    {
+      return _posted.depth();
+    }
+
+    /////////////////////////////////////////////////
+
+    //events refused because SSE_MAX_POSTED_EVENTS were already waiting
+    inline uint32_t postDropped() const
+    {
+      return _posted.dropped();
+    }
+
+    /////////////////////////////////////////////////
+
     size_t count() const; //number clinets connected
     size_t  avgPacketsWaiting() const;
 
     //system callbacks (do not call)
     void _addClient(AsyncEventSourceClient * client);
     void _handleDisconnect(AsyncEventSourceClient * client);
+    void _drainPosts();
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
     virtual void handleRequest(AsyncWebServerRequest *request) override final;
 };
@@ -371,7 +371,7 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
       if ( !request->contentType().equalsIgnoreCase(JSON_MIMETYPE) )
         return false;
 
-      request->addInterestingHeader("ANY");
+      request->addInterestingHeader(AWS_HDR_ANY);
 
       return true;
     }
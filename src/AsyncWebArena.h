@@ -0,0 +1,213 @@
+/****************************************************************************************************************************
+  AsyncWebArena.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBARENA_H_
+#define ASYNCWEBARENA_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/////////////////////////////////////////////////
+
+// Smallest block the arena allocates. Larger objects get a block of their own size
+#ifndef AWS_ARENA_BLOCK_SIZE
+  #define AWS_ARENA_BLOCK_SIZE    512
+#endif
+
+/////////////////////////////////////////////////
+
+// Per-request bump allocator. Memory is only released all at once by clear() or the destructor.
+// One object at a time can be grown with append() and closed with finish(), it stays contiguous
+class AsyncWebArena
+{
+  private:
+    typedef struct Block
+    {
+      struct Block * next;
+      size_t size;
+      size_t used;
+    } __attribute__((aligned(sizeof(void *)))) Block;
+
+    Block * _head;
+    size_t _openLen;
+    size_t _bytes;
+
+    /////////////////////////////////////////////////
+
+    inline char * _data(Block * b) const
+    {
+      return (char *) (b + 1);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Makes room for len more bytes of the open object, moving it to a new block if needed
+    bool _reserve(size_t len)
+    {
+      if (_head && (_head->size - _head->used - _openLen) >= len)
+        return true;
+
+      size_t need = _openLen + len;
+      size_t size = (need > AWS_ARENA_BLOCK_SIZE) ? need : AWS_ARENA_BLOCK_SIZE;
+      Block * b = (Block *) malloc(sizeof(Block) + size);
+
+      if (!b)
+        return false;
+
+      b->next = _head;
+      b->size = size;
+      b->used = 0;
+
+      if (_openLen)
+        memcpy(_data(b), _data(_head) + _head->used, _openLen);
+
+      _head = b;
+      _bytes += size;
+
+      return true;
+    }
+
+  public:
+    AsyncWebArena() : _head(NULL), _openLen(0), _bytes(0) {}
+
+    /////////////////////////////////////////////////
+
+    ~AsyncWebArena()
+    {
+      clear();
+    }
+
+    /////////////////////////////////////////////////
+
+    void clear()
+    {
+      while (_head)
+      {
+        Block * next = _head->next;
+
+        free(_head);
+        _head = next;
+      }
+
+      _openLen = 0;
+      _bytes = 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Pointer aligned, so records can be placed in the arena as well as strings
+    char * alloc(size_t len)
+    {
+      size_t pad = _head ? ((0 - _head->used) & (sizeof(void *) - 1)) : 0;
+
+      if (_openLen || !_reserve(len + pad))
+        return NULL;
+
+      // A fresh block starts aligned
+      _head->used += (0 - _head->used) & (sizeof(void *) - 1);
+
+      char * p = _data(_head) + _head->used;
+
+      _head->used += len;
+
+      return p;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Copies data into its own arena memory
+    inline char * copy(const char * data, size_t len)
+    {
+      char * p = alloc(len);
+
+      if (p && len)
+        memcpy(p, data, len);
+
+      return p;
+    }
+
+    /////////////////////////////////////////////////
+
+    bool append(const char * data, size_t len)
+    {
+      if (!len)
+        return true;
+
+      if (!_reserve(len))
+        return false;
+
+      memcpy(_data(_head) + _head->used + _openLen, data, len);
+      _openLen += len;
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Closes the object built by append(). Returns its start, NULL if it is empty
+    char * finish(size_t * len)
+    {
+      *len = _openLen;
+
+      if (!_openLen)
+        return NULL;
+
+      char * p = _data(_head) + _head->used;
+
+      _head->used += _openLen;
+      _openLen = 0;
+
+      return p;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Heap held by the arena
+    inline size_t bytes() const
+    {
+      return _bytes;
+    }
+};
+
+/////////////////////////////////////////////////
+
+#endif    // ASYNCWEBARENA_H_
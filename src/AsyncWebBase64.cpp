@@ -0,0 +1,200 @@
+/****************************************************************************************************************************
+  AsyncWebBase64.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebBase64.h"
+
+/////////////////////////////////////////////////
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Char to 6-bit value, 0xFF for anything outside the alphabet (including '=')
+static const uint8_t base64Values[256] =
+{
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+  0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/////////////////////////////////////////////////
+
+// Three bytes to four chars per iteration, then the padded tail
+size_t awsBase64Encode(const uint8_t * in, size_t len, char * out)
+{
+  char * p = out;
+
+  for ( ; len >= 3; in += 3, len -= 3, p += 4)
+  {
+    uint32_t v = ((uint32_t) in[0] << 16) | ((uint32_t) in[1] << 8) | in[2];
+
+    p[0] = base64Chars[v >> 18];
+    p[1] = base64Chars[(v >> 12) & 0x3F];
+    p[2] = base64Chars[(v >> 6) & 0x3F];
+    p[3] = base64Chars[v & 0x3F];
+  }
+
+  if (len)
+  {
+    uint32_t v = ((uint32_t) in[0] << 16) | ((len == 2) ? ((uint32_t) in[1] << 8) : 0);
+
+    p[0] = base64Chars[v >> 18];
+    p[1] = base64Chars[(v >> 12) & 0x3F];
+    p[2] = (len == 2) ? base64Chars[(v >> 6) & 0x3F] : '=';
+    p[3] = '=';
+    p += 4;
+  }
+
+  *p = 0;
+
+  return p - out;
+}
+
+/////////////////////////////////////////////////
+
+// Decoded length from the length and the padding only. Any other '=' is left to the char checks
+static size_t base64Length(const char * in, size_t len)
+{
+  if (len >= 4 && (len & 3) == 0)
+  {
+    if (in[len - 1] == '=')
+      len -= (in[len - 2] == '=') ? 2 : 1;
+  }
+
+  // One char left over can't hold a whole byte
+  if ((len & 3) == 1)
+    return AWS_BASE64_INVALID;
+
+  return (len / 4) * 3 + (((len & 3) == 0) ? 0 : ((len & 3) - 1));
+}
+
+/////////////////////////////////////////////////
+
+// Same checks as awsBase64Decode(), without writing anything
+size_t awsBase64DecodedLen(const char * in, size_t len)
+{
+  size_t outLen = base64Length(in, len);
+
+  if (outLen == AWS_BASE64_INVALID)
+    return AWS_BASE64_INVALID;
+
+  const uint8_t * s = (const uint8_t *) in;
+  size_t tail = outLen % 3;
+  size_t chars = (outLen / 3) * 4 + (tail ? tail + 1 : 0);
+  uint8_t all = 0;
+
+  for (size_t i = 0; i < chars; i++)
+    all |= base64Values[s[i]];
+
+  if (all & 0x80)
+    return AWS_BASE64_INVALID;
+
+  // The bits below the last byte must be zero, as in awsBase64Decode()
+  if (tail && (base64Values[s[chars - 1]] & ((tail == 1) ? 0x0F : 0x03)))
+    return AWS_BASE64_INVALID;
+
+  return outLen;
+}
+
+/////////////////////////////////////////////////
+
+// Four chars to three bytes per iteration. Invalid chars are caught by OR-ing the table values, whose top bit
+// is only set for 0xFF
+size_t awsBase64Decode(const char * in, size_t len, uint8_t * out)
+{
+  size_t outLen = base64Length(in, len);
+
+  if (outLen == AWS_BASE64_INVALID)
+    return AWS_BASE64_INVALID;
+
+  const uint8_t * s = (const uint8_t *) in;
+  uint8_t * p = out;
+  size_t full = outLen / 3;
+
+  for (size_t i = 0; i < full; i++, s += 4, p += 3)
+  {
+    uint8_t a = base64Values[s[0]];
+    uint8_t b = base64Values[s[1]];
+    uint8_t c = base64Values[s[2]];
+    uint8_t d = base64Values[s[3]];
+
+    if ((a | b | c | d) & 0x80)
+      return AWS_BASE64_INVALID;
+
+    uint32_t v = ((uint32_t) a << 18) | ((uint32_t) b << 12) | ((uint32_t) c << 6) | d;
+
+    p[0] = (uint8_t) (v >> 16);
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) v;
+  }
+
+  size_t tail = outLen - full * 3;
+
+  if (tail)
+  {
+    uint8_t a = base64Values[s[0]];
+    uint8_t b = base64Values[s[1]];
+    uint8_t c = (tail == 2) ? base64Values[s[2]] : 0;
+
+    // The bits below the last byte must be zero, or several encodings would decode the same
+    if (((a | b | c) & 0x80) || ((tail == 1) ? (b & 0x0F) : (c & 0x03)))
+      return AWS_BASE64_INVALID;
+
+    uint32_t v = ((uint32_t) a << 18) | ((uint32_t) b << 12) | ((uint32_t) c << 6);
+
+    p[0] = (uint8_t) (v >> 16);
+
+    if (tail == 2)
+      p[1] = (uint8_t) (v >> 8);
+  }
+
+  return outLen;
+}
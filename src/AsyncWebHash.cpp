@@ -0,0 +1,582 @@
+/****************************************************************************************************************************
+  AsyncWebHash.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebServer_WT32_ETH01.h"
+#include "AsyncWebHash.h"
+
+#include <limits.h>
+
+#if AWS_HASH_MBEDTLS
+  #include "mbedtls/version.h"
+
+  // The _ret variants replace the void ones from v2.7.0, and are renamed back in v3.0.0
+  #if (MBEDTLS_VERSION_NUMBER >= 0x02070000) && (MBEDTLS_VERSION_NUMBER < 0x03000000)
+    #define AWS_MBEDTLS(fn)     fn##_ret
+  #else
+    #define AWS_MBEDTLS(fn)     fn
+  #endif
+#endif
+
+/////////////////////////////////////////////////
+
+#if !AWS_HASH_MBEDTLS
+
+typedef void (*AwsSoftHashBlock)(uint32_t * state, const uint8_t * block);
+
+/////////////////////////////////////////////////
+
+#define ROTL32(x, n)    (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTR32(x, n)    (((x) >> (n)) | ((x) << (32 - (n))))
+
+static inline uint32_t loadLE32(const uint8_t * p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/////////////////////////////////////////////////
+
+static inline uint32_t loadBE32(const uint8_t * p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+/////////////////////////////////////////////////
+
+// RFC 1321. Each round is unrolled by four so the a, b, c, d rotation costs nothing
+static const uint32_t md5K[64] =
+{
+  0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+  0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+  0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+  0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+  0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+  0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+  0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+  0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+#define MD5_F(x, y, z)    ((z) ^ ((x) & ((y) ^ (z))))
+#define MD5_G(x, y, z)    ((y) ^ ((z) & ((x) ^ (y))))
+#define MD5_H(x, y, z)    ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z)    ((y) ^ ((x) | ~(z)))
+
+#define MD5_STEP(f, a, b, c, d, i, g, s)              \
+  (a) += f((b), (c), (d)) + w[(g)] + md5K[(i)];       \
+  (a) = ROTL32((a), (s)) + (b);
+
+static void md5Block(uint32_t * state, const uint8_t * block)
+{
+  uint32_t w[16];
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+  for (uint8_t i = 0; i < 16; i++)
+    w[i] = loadLE32(block + i * 4);
+
+  for (uint8_t i = 0; i < 16; i += 4)
+  {
+    MD5_STEP(MD5_F, a, b, c, d, i,     i,     7);
+    MD5_STEP(MD5_F, d, a, b, c, i + 1, i + 1, 12);
+    MD5_STEP(MD5_F, c, d, a, b, i + 2, i + 2, 17);
+    MD5_STEP(MD5_F, b, c, d, a, i + 3, i + 3, 22);
+  }
+
+  for (uint8_t i = 16; i < 32; i += 4)
+  {
+    MD5_STEP(MD5_G, a, b, c, d, i,     (5 * i + 1) & 15,  5);
+    MD5_STEP(MD5_G, d, a, b, c, i + 1, (5 * i + 6) & 15,  9);
+    MD5_STEP(MD5_G, c, d, a, b, i + 2, (5 * i + 11) & 15, 14);
+    MD5_STEP(MD5_G, b, c, d, a, i + 3, (5 * i + 16) & 15, 20);
+  }
+
+  for (uint8_t i = 32; i < 48; i += 4)
+  {
+    MD5_STEP(MD5_H, a, b, c, d, i,     (3 * i + 5) & 15,  4);
+    MD5_STEP(MD5_H, d, a, b, c, i + 1, (3 * i + 8) & 15,  11);
+    MD5_STEP(MD5_H, c, d, a, b, i + 2, (3 * i + 11) & 15, 16);
+    MD5_STEP(MD5_H, b, c, d, a, i + 3, (3 * i + 14) & 15, 23);
+  }
+
+  for (uint8_t i = 48; i < 64; i += 4)
+  {
+    MD5_STEP(MD5_I, a, b, c, d, i,     (7 * i) & 15,      6);
+    MD5_STEP(MD5_I, d, a, b, c, i + 1, (7 * i + 7) & 15,  10);
+    MD5_STEP(MD5_I, c, d, a, b, i + 2, (7 * i + 14) & 15, 15);
+    MD5_STEP(MD5_I, b, c, d, a, i + 3, (7 * i + 21) & 15, 21);
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+}
+
+/////////////////////////////////////////////////
+
+// FIPS 180-4. The message schedule is kept as a rolling 16 word window, and eight rounds are unrolled
+// per loop so the working variables never move
+static const uint32_t sha256K[64] =
+{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define SHA256_S0(x)      (ROTR32((x), 2) ^ ROTR32((x), 13) ^ ROTR32((x), 22))
+#define SHA256_S1(x)      (ROTR32((x), 6) ^ ROTR32((x), 11) ^ ROTR32((x), 25))
+#define SHA256_G0(x)      (ROTR32((x), 7) ^ ROTR32((x), 18) ^ ((x) >> 3))
+#define SHA256_G1(x)      (ROTR32((x), 17) ^ ROTR32((x), 19) ^ ((x) >> 10))
+#define SHA256_CH(x, y, z)    ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA256_MAJ(x, y, z)   (((x) & (y)) | ((z) & ((x) | (y))))
+
+#define SHA256_W(i)   (w[(i) & 15] += SHA256_G1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SHA256_G0(w[((i) - 15) & 15]))
+
+#define SHA256_STEP(a, b, c, d, e, f, g, h, i, x)                     \
+  t = (h) + SHA256_S1(e) + SHA256_CH((e), (f), (g)) + sha256K[(i)] + (x); \
+  (d) += t;                                                           \
+  (h) = t + SHA256_S0(a) + SHA256_MAJ((a), (b), (c));
+
+static void sha256Block(uint32_t * state, const uint8_t * block)
+{
+  uint32_t w[16];
+  uint32_t t;
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+  for (uint8_t i = 0; i < 16; i++)
+    w[i] = loadBE32(block + i * 4);
+
+  for (uint8_t i = 0; i < 16; i += 8)
+  {
+    SHA256_STEP(a, b, c, d, e, f, g, h, i,     w[i]);
+    SHA256_STEP(h, a, b, c, d, e, f, g, i + 1, w[i + 1]);
+    SHA256_STEP(g, h, a, b, c, d, e, f, i + 2, w[i + 2]);
+    SHA256_STEP(f, g, h, a, b, c, d, e, i + 3, w[i + 3]);
+    SHA256_STEP(e, f, g, h, a, b, c, d, i + 4, w[i + 4]);
+    SHA256_STEP(d, e, f, g, h, a, b, c, i + 5, w[i + 5]);
+    SHA256_STEP(c, d, e, f, g, h, a, b, i + 6, w[i + 6]);
+    SHA256_STEP(b, c, d, e, f, g, h, a, i + 7, w[i + 7]);
+  }
+
+  for (uint8_t i = 16; i < 64; i += 8)
+  {
+    SHA256_STEP(a, b, c, d, e, f, g, h, i,     SHA256_W(i));
+    SHA256_STEP(h, a, b, c, d, e, f, g, i + 1, SHA256_W(i + 1));
+    SHA256_STEP(g, h, a, b, c, d, e, f, i + 2, SHA256_W(i + 2));
+    SHA256_STEP(f, g, h, a, b, c, d, e, i + 3, SHA256_W(i + 3));
+    SHA256_STEP(e, f, g, h, a, b, c, d, i + 4, SHA256_W(i + 4));
+    SHA256_STEP(d, e, f, g, h, a, b, c, i + 5, SHA256_W(i + 5));
+    SHA256_STEP(c, d, e, f, g, h, a, b, i + 6, SHA256_W(i + 6));
+    SHA256_STEP(b, c, d, e, f, g, h, a, i + 7, SHA256_W(i + 7));
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+/////////////////////////////////////////////////
+
+// Whole blocks are hashed straight from data, only the tail is copied into the buffer
+static void softUpdate(AwsSoftHashContext * ctx, AwsSoftHashBlock block, const uint8_t * data, size_t len)
+{
+  size_t fill = ctx->total & 63;
+
+  ctx->total += len;
+
+  if (fill)
+  {
+    size_t n = ((64 - fill) < len) ? (64 - fill) : len;
+
+    memcpy(ctx->buffer + fill, data, n);
+    data += n;
+    len  -= n;
+
+    if (fill + n < 64)
+      return;
+
+    block(ctx->state, ctx->buffer);
+  }
+
+  for ( ; len >= 64; data += 64, len -= 64)
+    block(ctx->state, data);
+
+  if (len)
+    memcpy(ctx->buffer, data, len);
+}
+
+/////////////////////////////////////////////////
+
+// MD5 appends the bit length little endian, SHA-2 big endian
+static void softFinish(AwsSoftHashContext * ctx, AwsSoftHashBlock block, bool bigEndian)
+{
+  uint64_t bits = ctx->total << 3;
+  size_t fill = ctx->total & 63;
+
+  ctx->buffer[fill++] = 0x80;
+
+  if (fill > 56)
+  {
+    memset(ctx->buffer + fill, 0, 64 - fill);
+    block(ctx->state, ctx->buffer);
+    fill = 0;
+  }
+
+  memset(ctx->buffer + fill, 0, 56 - fill);
+
+  for (uint8_t i = 0; i < 8; i++)
+    ctx->buffer[bigEndian ? (63 - i) : (56 + i)] = (uint8_t) (bits >> (i * 8));
+
+  block(ctx->state, ctx->buffer);
+}
+
+#endif    // !AWS_HASH_MBEDTLS
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+AsyncWebHash::AsyncWebHash(AwsHashType type)
+  : _type(type)
+{
+  _init();
+  begin();
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebHash::AsyncWebHash(const AsyncWebHash& other)
+  : _type(other._type)
+{
+  _init();
+  *this = other;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebHash::~AsyncWebHash()
+{
+  _free();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHash::_init()
+{
+#if AWS_HASH_MBEDTLS
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      mbedtls_md5_init(&_ctx.md5);
+      break;
+
+    case AWS_HASH_SHA1:
+      mbedtls_sha1_init(&_ctx.sha1);
+      break;
+
+    default:
+      mbedtls_sha256_init(&_ctx.sha256);
+      break;
+  }
+
+#else
+  memset(&_ctx, 0, sizeof(_ctx));
+#endif
+}
+
+/////////////////////////////////////////////////
+
+// Also gives back the SHA peripheral if this context holds it
+void AsyncWebHash::_free()
+{
+#if AWS_HASH_MBEDTLS
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      mbedtls_md5_free(&_ctx.md5);
+      break;
+
+    case AWS_HASH_SHA1:
+      mbedtls_sha1_free(&_ctx.sha1);
+      break;
+
+    default:
+      mbedtls_sha256_free(&_ctx.sha256);
+      break;
+  }
+
+#endif
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebHash& AsyncWebHash::operator=(const AsyncWebHash& other)
+{
+  if (this == &other)
+    return *this;
+
+  if (_type != other._type)
+  {
+    _free();
+    _type = other._type;
+    _init();
+  }
+
+#if AWS_HASH_MBEDTLS
+
+  // mbedtls_*_clone() rather than a plain copy, as the state may live in the accelerator
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      mbedtls_md5_clone(&_ctx.md5, &other._ctx.md5);
+      break;
+
+    case AWS_HASH_SHA1:
+      mbedtls_sha1_clone(&_ctx.sha1, &other._ctx.sha1);
+      break;
+
+    default:
+      mbedtls_sha256_clone(&_ctx.sha256, &other._ctx.sha256);
+      break;
+  }
+
+#else
+  _ctx = other._ctx;
+#endif
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHash::begin()
+{
+#if AWS_HASH_MBEDTLS
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      AWS_MBEDTLS(mbedtls_md5_starts)(&_ctx.md5);
+      break;
+
+    case AWS_HASH_SHA1:
+      AWS_MBEDTLS(mbedtls_sha1_starts)(&_ctx.sha1);
+      break;
+
+    default:
+      AWS_MBEDTLS(mbedtls_sha256_starts)(&_ctx.sha256, 0);
+      break;
+  }
+
+#else
+
+  static const uint32_t md5Init[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+  static const uint32_t sha256Init[8] =
+  {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      memcpy(_ctx.soft.state, md5Init, sizeof(md5Init));
+      _ctx.soft.total = 0;
+      break;
+
+    case AWS_HASH_SHA1:
+      sha1_starts(&_ctx.sha1);
+      break;
+
+    default:
+      memcpy(_ctx.soft.state, sha256Init, sizeof(sha256Init));
+      _ctx.soft.total = 0;
+      break;
+  }
+
+#endif
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHash::update(const void * data, size_t len)
+{
+  const uint8_t * p = (const uint8_t *) data;
+
+#if AWS_HASH_MBEDTLS
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      AWS_MBEDTLS(mbedtls_md5_update)(&_ctx.md5, p, len);
+      break;
+
+    case AWS_HASH_SHA1:
+      AWS_MBEDTLS(mbedtls_sha1_update)(&_ctx.sha1, p, len);
+      break;
+
+    default:
+      AWS_MBEDTLS(mbedtls_sha256_update)(&_ctx.sha256, p, len);
+      break;
+  }
+
+#else
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      softUpdate(&_ctx.soft, md5Block, p, len);
+      break;
+
+    case AWS_HASH_SHA1:
+      // sha1_update() takes an int length
+      for ( ; len > INT_MAX; p += INT_MAX, len -= INT_MAX)
+        sha1_update(&_ctx.sha1, p, INT_MAX);
+
+      sha1_update(&_ctx.sha1, p, (int) len);
+      break;
+
+    default:
+      softUpdate(&_ctx.soft, sha256Block, p, len);
+      break;
+  }
+
+#endif
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebHash::finish(uint8_t * digest)
+{
+#if AWS_HASH_MBEDTLS
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      AWS_MBEDTLS(mbedtls_md5_finish)(&_ctx.md5, digest);
+      break;
+
+    case AWS_HASH_SHA1:
+      AWS_MBEDTLS(mbedtls_sha1_finish)(&_ctx.sha1, digest);
+      break;
+
+    default:
+      AWS_MBEDTLS(mbedtls_sha256_finish)(&_ctx.sha256, digest);
+      break;
+  }
+
+#else
+
+  switch (_type)
+  {
+    case AWS_HASH_MD5:
+      softFinish(&_ctx.soft, md5Block, false);
+
+      for (uint8_t i = 0; i < 4; i++)
+      {
+        digest[i * 4]     = (uint8_t) _ctx.soft.state[i];
+        digest[i * 4 + 1] = (uint8_t) (_ctx.soft.state[i] >> 8);
+        digest[i * 4 + 2] = (uint8_t) (_ctx.soft.state[i] >> 16);
+        digest[i * 4 + 3] = (uint8_t) (_ctx.soft.state[i] >> 24);
+      }
+
+      break;
+
+    case AWS_HASH_SHA1:
+      sha1_finish(&_ctx.sha1, digest);
+      break;
+
+    default:
+      softFinish(&_ctx.soft, sha256Block, true);
+
+      for (uint8_t i = 0; i < 8; i++)
+      {
+        digest[i * 4]     = (uint8_t) (_ctx.soft.state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t) (_ctx.soft.state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t) (_ctx.soft.state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t) _ctx.soft.state[i];
+      }
+
+      break;
+  }
+
+#endif
+
+  begin();
+
+  return size();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHash::finishHex(char * hex)
+{
+  static const char hexDigits[] = "0123456789abcdef";
+  uint8_t digest[AWS_HASH_MAX_SIZE];
+  size_t len = finish(digest);
+
+  for (size_t i = 0; i < len; i++)
+  {
+    hex[i * 2]     = hexDigits[digest[i] >> 4];
+    hex[i * 2 + 1] = hexDigits[digest[i] & 0x0F];
+  }
+
+  hex[len * 2] = 0;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebHash::digest(AwsHashType type, const void * data, size_t len, uint8_t * digest)
+{
+  AsyncWebHash hash(type);
+
+  hash.update(data, len);
+
+  return hash.finish(digest);
+}
@@ -0,0 +1,164 @@
+/****************************************************************************************************************************
+  AsyncWebHash.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBHASH_H_
+#define ASYNCWEBHASH_H_
+
+#include <Arduino.h>
+
+// On the ESP32 the hashes go through mbedtls, which ESP-IDF backs with the SHA accelerator for SHA-1 and SHA-256
+// (MD5 has no hardware and stays in software). Host builds (AWS_HOST_BUILD, or not an ESP32) use the portable
+// software implementations in AsyncWebHash.cpp instead
+#if defined(ESP32) && !defined(AWS_HOST_BUILD)
+  #define AWS_HASH_MBEDTLS          1
+
+  #include "mbedtls/md5.h"
+  #include "mbedtls/sha1.h"
+  #include "mbedtls/sha256.h"
+#else
+  #define AWS_HASH_MBEDTLS          0
+
+  #include "Crypto/sha1.h"
+
+  // MD5 and SHA-256 software state, sharing the 64 byte block buffering
+  typedef struct
+  {
+    uint32_t state[8];
+    uint64_t total;
+    uint8_t buffer[64];
+  } AwsSoftHashContext;
+#endif
+
+/////////////////////////////////////////////////
+
+typedef enum : uint8_t
+{
+  AWS_HASH_MD5,
+  AWS_HASH_SHA1,
+  AWS_HASH_SHA256
+} AwsHashType;
+
+#define AWS_MD5_SIZE                16
+#define AWS_SHA1_SIZE               20
+#define AWS_SHA256_SIZE             32
+
+// Largest digest, to size buffers for any AwsHashType
+#define AWS_HASH_MAX_SIZE           AWS_SHA256_SIZE
+
+// Input block size of all three, e.g. for HMAC key pads
+#define AWS_HASH_BLOCK_SIZE         64
+
+/////////////////////////////////////////////////
+
+// Incremental MD5 / SHA-1 / SHA-256 without heap use. Copying a hash clones its state, so a common prefix
+// can be hashed once and reused. finish() leaves the hash ready for the next message. On the ESP32 a hash
+// that has processed a block holds the SHA accelerator until finish(), so don't keep one part-fed for long
+class AsyncWebHash
+{
+  private:
+    AwsHashType _type;
+
+    union
+    {
+#if AWS_HASH_MBEDTLS
+      mbedtls_md5_context md5;
+      mbedtls_sha1_context sha1;
+      mbedtls_sha256_context sha256;
+#else
+      AwsSoftHashContext soft;
+      sha1_context sha1;
+#endif
+    } _ctx;
+
+    void _init();
+    void _free();
+
+  public:
+    AsyncWebHash(AwsHashType type);
+    AsyncWebHash(const AsyncWebHash& other);
+    ~AsyncWebHash();
+
+    AsyncWebHash& operator=(const AsyncWebHash& other);
+
+    // Drops any input so far
+    void begin();
+    void update(const void * data, size_t len);
+
+    // digest : size() bytes. Returns size()
+    size_t finish(uint8_t * digest);
+
+    // hex : 2 * size() + 1 bytes, lower case and null terminated
+    void finishHex(char * hex);
+
+    /////////////////////////////////////////////////
+
+    inline void update(const String& data)
+    {
+      update(data.c_str(), data.length());
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsHashType type() const
+    {
+      return _type;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t size() const
+    {
+      return size(_type);
+    }
+
+    /////////////////////////////////////////////////
+
+    static inline size_t size(AwsHashType type)
+    {
+      return (type == AWS_HASH_MD5) ? AWS_MD5_SIZE : ((type == AWS_HASH_SHA1) ? AWS_SHA1_SIZE : AWS_SHA256_SIZE);
+    }
+
+    /////////////////////////////////////////////////
+
+    // One shot hash of data into digest (size(type) bytes). Returns size(type)
+    static size_t digest(AwsHashType type, const void * data, size_t len, uint8_t * digest);
+};
+
+#endif /* ASYNCWEBHASH_H_ */
@@ -0,0 +1,146 @@
+/****************************************************************************************************************************
+  AsyncWebHeaderId.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebHeaderId.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+/////////////////////////////////////////////////
+
+static const char * const awsHeaderNames[AWS_HDR_COUNT] =
+{
+  "Host",
+  "Content-Type",
+  "Content-Length",
+  "Expect",
+  "Authorization",
+  "Upgrade",
+  "Accept",
+  "Connection",
+  "Origin",
+  "Sec-WebSocket-Key",
+  "Sec-WebSocket-Version",
+  "Sec-WebSocket-Protocol",
+  "Sec-WebSocket-Extensions",
+  "If-Modified-Since",
+  "If-None-Match",
+  "Last-Event-ID",
+  "Cookie",
+  "User-Agent",
+  "Accept-Encoding",
+  "Accept-Language",
+  "Cache-Control",
+  "Referer",
+  "Range",
+  "Transfer-Encoding",
+  "Content-Encoding",
+  "Pragma",
+  "X-Requested-With",
+  "Keep-Alive",
+};
+
+/////////////////////////////////////////////////
+
+// Perfect hash over awsHeaderNames: first, middle and last character plus the length.
+// Each well-known name has its own slot, so a lookup is one hash and one strncasecmp()
+#define AWS_HDR_HASH_SLOTS      64
+
+static inline uint8_t awsHeaderSlot(const char *name, size_t len)
+{
+  const uint8_t * p = (const uint8_t *) name;
+
+  return (tolower(p[0]) + tolower(p[len - 1]) * 17 + tolower(p[len / 2]) + len * 33) & (AWS_HDR_HASH_SLOTS - 1);
+}
+
+static const uint8_t awsHeaderSlots[AWS_HDR_HASH_SLOTS] =
+{
+  0x06, 0xFF, 0xFF, 0x05, 0x03, 0x04, 0x02, 0xFF,
+  0xFF, 0x10, 0xFF, 0x1B, 0x12, 0xFF, 0x19, 0xFF,
+  0x15, 0xFF, 0xFF, 0x00, 0x11, 0xFF, 0xFF, 0xFF,
+  0x01, 0xFF, 0x0B, 0xFF, 0x09, 0xFF, 0x07, 0x14,
+  0xFF, 0x0A, 0x0C, 0x0E, 0x1A, 0xFF, 0xFF, 0xFF,
+  0xFF, 0x17, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0x18,
+  0xFF, 0x13, 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF,
+  0x0D, 0xFF, 0x16, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/////////////////////////////////////////////////
+
+AwsHeaderId awsHeaderId(const char *name, size_t len)
+{
+  if (!name || !len)
+    return AWS_HDR_UNKNOWN;
+
+  uint8_t id = awsHeaderSlots[awsHeaderSlot(name, len)];
+
+  if (id == AWS_HDR_UNKNOWN)
+    return AWS_HDR_UNKNOWN;
+
+  const char * known = awsHeaderNames[id];
+
+  if ((strlen(known) != len) || strncasecmp(name, known, len))
+    return AWS_HDR_UNKNOWN;
+
+  return (AwsHeaderId) id;
+}
+
+/////////////////////////////////////////////////
+
+const char * awsHeaderName(AwsHeaderId id)
+{
+  return (id < AWS_HDR_COUNT) ? awsHeaderNames[id] : NULL;
+}
+
+/////////////////////////////////////////////////
+
+uint32_t awsHeaderHash(const char *name, size_t len)
+{
+  uint32_t hash = 2166136261UL;
+
+  while (len--)
+  {
+    hash ^= (uint8_t) tolower(*name++);
+    hash *= 16777619UL;
+  }
+
+  return hash;
+}
@@ -0,0 +1,100 @@
+/****************************************************************************************************************************
+  AsyncWebHeaderId.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBHEADERID_H_
+#define ASYNCWEBHEADERID_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////
+
+// Well-known request headers. The server matches these by id, and requests track them in 32-bit masks
+typedef enum : uint8_t
+{
+  AWS_HDR_HOST                 = 0,
+  AWS_HDR_CONTENT_TYPE         = 1,
+  AWS_HDR_CONTENT_LENGTH       = 2,
+  AWS_HDR_EXPECT               = 3,
+  AWS_HDR_AUTHORIZATION        = 4,
+  AWS_HDR_UPGRADE              = 5,
+  AWS_HDR_ACCEPT               = 6,
+  AWS_HDR_CONNECTION           = 7,
+  AWS_HDR_ORIGIN               = 8,
+  AWS_HDR_WS_KEY               = 9,
+  AWS_HDR_WS_VERSION           = 10,
+  AWS_HDR_WS_PROTOCOL          = 11,
+  AWS_HDR_WS_EXTENSIONS        = 12,
+  AWS_HDR_IF_MODIFIED_SINCE    = 13,
+  AWS_HDR_IF_NONE_MATCH        = 14,
+  AWS_HDR_LAST_EVENT_ID        = 15,
+  AWS_HDR_COOKIE               = 16,
+  AWS_HDR_USER_AGENT           = 17,
+  AWS_HDR_ACCEPT_ENCODING      = 18,
+  AWS_HDR_ACCEPT_LANGUAGE      = 19,
+  AWS_HDR_CACHE_CONTROL        = 20,
+  AWS_HDR_REFERER              = 21,
+  AWS_HDR_RANGE                = 22,
+  AWS_HDR_TRANSFER_ENCODING    = 23,
+  AWS_HDR_CONTENT_ENCODING     = 24,
+  AWS_HDR_PRAGMA               = 25,
+  AWS_HDR_X_REQUESTED_WITH     = 26,
+  AWS_HDR_KEEP_ALIVE           = 27,
+
+  AWS_HDR_COUNT,
+
+  AWS_HDR_ANY                  = 0xFE,    // addInterestingHeader(AWS_HDR_ANY) keeps every header
+  AWS_HDR_UNKNOWN              = 0xFF
+} AwsHeaderId;
+
+#define AWS_HDR_BIT(id)       (1UL << (id))
+
+/////////////////////////////////////////////////
+
+// Case-insensitive lookup of a header name, AWS_HDR_UNKNOWN if it isn't a well-known one
+AwsHeaderId awsHeaderId(const char *name, size_t len);
+
+// Canonical spelling of a well-known header, NULL for AWS_HDR_UNKNOWN / AWS_HDR_ANY
+const char * awsHeaderName(AwsHeaderId id);
+
+// Case-insensitive FNV-1a hash, used to index header names that aren't well-known
+uint32_t awsHeaderHash(const char *name, size_t len);
+
+#endif /* ASYNCWEBHEADERID_H_ */
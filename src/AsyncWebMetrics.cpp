@@ -0,0 +1,364 @@
+/****************************************************************************************************************************
+  AsyncWebMetrics.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebServer_WT32_ETH01.h"
+
+#if AWS_METRICS
+
+#include <stdio.h>
+
+/////////////////////////////////////////////////
+
+static const uint32_t bucketBounds[] = { AWS_METRICS_BUCKET_BOUNDS };
+
+static_assert(sizeof(bucketBounds) / sizeof(bucketBounds[0]) == AWS_METRICS_BUCKETS - 1,
+              "AWS_METRICS_BUCKETS must be one more than the number of AWS_METRICS_BUCKET_BOUNDS");
+
+/////////////////////////////////////////////////
+
+AsyncWebHistogram::AsyncWebHistogram()
+{
+  for (uint8_t i = 0; i < AWS_METRICS_BUCKETS; i++)
+    _buckets[i].store(0, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHistogram::observe(uint32_t us)
+{
+  uint8_t i = 0;
+
+  while (i < AWS_METRICS_BUCKETS - 1 && us > bucketBounds[i])
+    i++;
+
+  _buckets[i].fetch_add(1, std::memory_order_relaxed);
+  _sum.add(us);
+}
+
+/////////////////////////////////////////////////
+
+uint32_t AsyncWebHistogram::bound(uint8_t i)
+{
+  return (i < AWS_METRICS_BUCKETS - 1) ? bucketBounds[i] : 0;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+AsyncWebHandlerMetrics::AsyncWebHandlerMetrics()
+{
+  for (uint8_t i = 0; i < AWS_STATUS_CLASSES; i++)
+    _requests[i].store(0, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHandlerMetrics::countRequest(int code)
+{
+  uint8_t status = (code >= 100 && code < 600) ? (code / 100 - 1) : AWS_STATUS_ABORTED;
+
+  _requests[status].fetch_add(1, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Prometheus exporter
+ * */
+
+typedef struct
+{
+  const char * name;
+  const char * help;
+  bool histogram;
+} AwsMetricFamily;
+
+// Rendered in this order, _render()'s family is an index in here
+static const AwsMetricFamily metricFamilies[] =
+{
+  { "aws_http_requests_total",              "Requests by status class, aborted when no response was sent", false },
+  { "aws_http_request_bytes_total",         "Bytes received from clients", false },
+  { "aws_http_response_bytes_total",        "Bytes acknowledged by clients, up to the hand over for WebSocket", false },
+  { "aws_http_time_to_handler_seconds",     "Connection accept to handler chosen", true },
+  { "aws_http_time_to_first_byte_seconds",  "Connection accept to response start", true },
+  { "aws_http_time_to_last_ack_seconds",    "Connection accept to the last response byte acknowledged, "
+                                            "without responses ended by closing the connection", true }
+};
+
+#define METRIC_FAMILIES     (sizeof(metricFamilies) / sizeof(metricFamilies[0]))
+
+static const char * statusClasses[AWS_STATUS_CLASSES] = { "1xx", "2xx", "3xx", "4xx", "5xx", "aborted" };
+
+/////////////////////////////////////////////////
+
+static void appendU64(String& out, uint64_t value)
+{
+  char buf[21];
+
+  snprintf(buf, sizeof(buf), "%llu", (unsigned long long) value);
+  out.concat(buf);
+}
+
+/////////////////////////////////////////////////
+
+// us as seconds, without trailing zeros : 500 => 0.0005
+static void appendSeconds(String& out, uint64_t us)
+{
+  char buf[32];
+  int len = snprintf(buf, sizeof(buf), "%llu.%06lu", (unsigned long long) (us / 1000000), (unsigned long) (us % 1000000));
+
+  while (buf[len - 1] == '0')
+    len--;
+
+  if (buf[len - 1] == '.')
+    len--;
+
+  buf[len] = 0;
+  out.concat(buf);
+}
+
+/////////////////////////////////////////////////
+
+// Opens the label set, the caller adds its own labels and the closing brace
+static void appendLabels(String& out, const char * name, const char * suffix, const String& handler, const String& route)
+{
+  out.concat(name);
+  out.concat(suffix);
+  out.concat("{handler=\"");
+  out.concat(handler);
+  out.concat("\",route=\"");
+
+  for (size_t i = 0; i < route.length(); i++)
+  {
+    char c = route[i];
+
+    if (c == '\\' || c == '"')
+      out.concat('\\');
+    else if (c == '\n')
+    {
+      out.concat("\\n");
+      continue;
+    }
+
+    out.concat(c);
+  }
+
+  out.concat('"');
+}
+
+/////////////////////////////////////////////////
+
+// Feeds the response from AsyncWebMetricsHandler::_render(), one family of one handler buffered at a time
+class AwsMetricsFiller
+{
+  private:
+    const AsyncWebMetricsHandler * _handler;
+    uint8_t _family;
+    size_t _n;
+    String _pending;
+    size_t _offset;
+
+  public:
+    AwsMetricsFiller(const AsyncWebMetricsHandler * handler)
+      : _handler(handler), _family(0), _n(0), _pending(), _offset(0) {}
+
+    /////////////////////////////////////////////////
+
+    size_t operator()(uint8_t * buffer, size_t maxLen, size_t index)
+    {
+      WT32_ETH01_AWS_UNUSED(index);
+
+      size_t len = 0;
+
+      while (len < maxLen)
+      {
+        if (_offset >= _pending.length())
+        {
+          _pending.remove(0);
+          _offset = 0;
+
+          if (_family >= METRIC_FAMILIES)
+            break;
+
+          if (_handler->_render(_family, _n, _pending))
+          {
+            _n++;
+          }
+          else
+          {
+            _family++;
+            _n = 0;
+          }
+
+          continue;
+        }
+
+        size_t n = ((maxLen - len) < (_pending.length() - _offset)) ? (maxLen - len) : (_pending.length() - _offset);
+
+        memcpy(buffer + len, _pending.c_str() + _offset, n);
+        len += n;
+        _offset += n;
+      }
+
+      return len;
+    }
+};
+
+/////////////////////////////////////////////////
+
+bool AsyncWebMetricsHandler::canHandle(AsyncWebServerRequest *request)
+{
+  return (request->method() == HTTP_GET && request->url().equals(_uri));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebMetricsHandler::handleRequest(AsyncWebServerRequest *request)
+{
+  if (!_authorized(request))
+    return _requestAuthorization(request);
+
+  // No Content-Length, the connection is closed after the last line
+  request->send(request->beginResponse("text/plain; version=0.0.4; charset=utf-8", 0, AwsMetricsFiller(this)));
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebMetricsHandler::_render(uint8_t family, size_t n, String& out) const
+{
+  if (family >= METRIC_FAMILIES)
+    return false;
+
+  const AsyncWebHandler * h = NULL;
+  String id;
+  size_t i = 0;
+
+  for (const auto& handler : _server->_handlers)
+  {
+    if (i++ == n)
+    {
+      h = handler;
+      id = String((unsigned long) n);
+
+      break;
+    }
+  }
+
+  if (h == NULL)
+  {
+    if (n != i || _server->_catchAllHandler == NULL)
+      return false;
+
+    h = _server->_catchAllHandler;
+    id = "notFound";
+  }
+
+  const AwsMetricFamily& f = metricFamilies[family];
+  const AsyncWebHandlerMetrics& m = h->metrics();
+  String route = h->metricsName();
+
+  if (n == 0)
+  {
+    out.concat("# HELP ");
+    out.concat(f.name);
+    out.concat(' ');
+    out.concat(f.help);
+    out.concat("\n# TYPE ");
+    out.concat(f.name);
+    out.concat(f.histogram ? " histogram\n" : " counter\n");
+  }
+
+  if (family == 0)
+  {
+    for (uint8_t s = 0; s < AWS_STATUS_CLASSES; s++)
+    {
+      appendLabels(out, f.name, "", id, route);
+      out.concat(",code=\"");
+      out.concat(statusClasses[s]);
+      out.concat("\"} ");
+      appendU64(out, m.requests((AwsStatusClass) s));
+      out.concat('\n');
+    }
+  }
+  else if (!f.histogram)
+  {
+    appendLabels(out, f.name, "", id, route);
+    out.concat("} ");
+    appendU64(out, (family == 1) ? m.bytesIn.value() : m.bytesOut.value());
+    out.concat('\n');
+  }
+  else
+  {
+    const AsyncWebHistogram& hist = (family == 3) ? m.timeToHandler : ((family == 4) ? m.timeToFirstByte : m.timeToLastAck);
+    uint64_t count = 0;
+
+    for (uint8_t b = 0; b < AWS_METRICS_BUCKETS; b++)
+    {
+      count += hist.bucket(b);
+
+      appendLabels(out, f.name, "_bucket", id, route);
+      out.concat(",le=\"");
+
+      if (b < AWS_METRICS_BUCKETS - 1)
+        appendSeconds(out, AsyncWebHistogram::bound(b));
+      else
+        out.concat("+Inf");
+
+      out.concat("\"} ");
+      appendU64(out, count);
+      out.concat('\n');
+    }
+
+    appendLabels(out, f.name, "_sum", id, route);
+    out.concat("} ");
+    appendSeconds(out, hist.sum());
+    out.concat('\n');
+
+    appendLabels(out, f.name, "_count", id, route);
+    out.concat("} ");
+    appendU64(out, count);
+    out.concat('\n');
+  }
+
+  return true;
+}
+
+#endif    // AWS_METRICS
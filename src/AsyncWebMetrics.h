@@ -0,0 +1,183 @@
+/****************************************************************************************************************************
+  AsyncWebMetrics.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBMETRICS_H_
+#define ASYNCWEBMETRICS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/////////////////////////////////////////////////
+
+// Per handler request counters and latency histograms, see AsyncWebMetricsHandler. -DAWS_METRICS=0 compiles them out
+#ifndef AWS_METRICS
+  #define AWS_METRICS                   1
+#endif
+
+// Histogram upper bounds in us, the last bucket is +Inf
+#define AWS_METRICS_BUCKET_BOUNDS       500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, \
+                                        1000000, 2500000, 5000000
+#define AWS_METRICS_BUCKETS             14
+
+/////////////////////////////////////////////////
+
+// 64-bit counter from two 32-bit atomics, as the ESP32 has no lock-free 64-bit ones. A reader racing the carry
+// can see the low word wrapped before the high word moves, i.e. one short dip that Prometheus takes as a reset
+class AsyncWebMetricCounter
+{
+  private:
+    std::atomic<uint32_t> _low;
+    std::atomic<uint32_t> _high;
+
+  public:
+    AsyncWebMetricCounter() : _low(0), _high(0) {}
+
+    /////////////////////////////////////////////////
+
+    inline void add(uint32_t n)
+    {
+      uint32_t old = _low.fetch_add(n, std::memory_order_relaxed);
+
+      if ((uint32_t) (old + n) < old)
+        _high.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint64_t value() const
+    {
+      uint32_t high;
+      uint32_t low;
+
+      do
+      {
+        high = _high.load(std::memory_order_relaxed);
+        low  = _low.load(std::memory_order_relaxed);
+      } while (high != _high.load(std::memory_order_relaxed));
+
+      return ((uint64_t) high << 32) | low;
+    }
+};
+
+/////////////////////////////////////////////////
+
+// Fixed buckets (AWS_METRICS_BUCKET_BOUNDS) counted separately, made cumulative only when exported
+class AsyncWebHistogram
+{
+  private:
+    std::atomic<uint32_t> _buckets[AWS_METRICS_BUCKETS];
+    AsyncWebMetricCounter _sum;
+
+  public:
+    AsyncWebHistogram();
+
+    void observe(uint32_t us);
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t bucket(uint8_t i) const
+    {
+      return _buckets[i].load(std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Total of all observations, in us
+    inline uint64_t sum() const
+    {
+      return _sum.value();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Upper bound of bucket i in us, 0 for the +Inf one
+    static uint32_t bound(uint8_t i);
+};
+
+/////////////////////////////////////////////////
+
+// Status classes counted by AsyncWebHandlerMetrics. AWS_STATUS_ABORTED : the connection closed before a response
+typedef enum : uint8_t
+{
+  AWS_STATUS_1XX,
+  AWS_STATUS_2XX,
+  AWS_STATUS_3XX,
+  AWS_STATUS_4XX,
+  AWS_STATUS_5XX,
+  AWS_STATUS_ABORTED,
+  AWS_STATUS_CLASSES
+} AwsStatusClass;
+
+/////////////////////////////////////////////////
+
+// What one AsyncWebHandler has served. All members are updated lock-free, from the AsyncTCP task or a worker
+class AsyncWebHandlerMetrics
+{
+  private:
+    std::atomic<uint32_t> _requests[AWS_STATUS_CLASSES];
+
+  public:
+    AsyncWebMetricCounter bytesIn;
+    AsyncWebMetricCounter bytesOut;
+
+    // From the connection accept to the handler being chosen, i.e. receiving and parsing the headers
+    AsyncWebHistogram timeToHandler;
+
+    // From the connection accept to the response starting to send
+    AsyncWebHistogram timeToFirstByte;
+
+    // From the connection accept to the client acknowledging the last byte of the response
+    AsyncWebHistogram timeToLastAck;
+
+    AsyncWebHandlerMetrics();
+
+    // code : HTTP status, or 0 when no response was sent
+    void countRequest(int code);
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t requests(AwsStatusClass status) const
+    {
+      return _requests[status].load(std::memory_order_relaxed);
+    }
+};
+
+#endif /* ASYNCWEBMETRICS_H_ */
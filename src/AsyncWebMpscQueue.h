@@ -0,0 +1,183 @@
+/****************************************************************************************************************************
+  AsyncWebMpscQueue.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBMPSCQUEUE_H_
+#define ASYNCWEBMPSCQUEUE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/////////////////////////////////////////////////
+
+// Item of an AsyncWebMpscQueue. Owned by the queue between push() and pop()
+class AsyncWebMpscNode
+{
+    friend class AsyncWebMpscQueue;
+
+  private:
+    std::atomic<AsyncWebMpscNode *> _mpscNext;
+
+  public:
+    AsyncWebMpscNode() : _mpscNext(nullptr) {}
+    virtual ~AsyncWebMpscNode() {}
+};
+
+/////////////////////////////////////////////////
+
+// Intrusive multi-producer / single-consumer queue (D. Vyukov). push() is wait-free and may be called
+// from any task or core, pop() must only be called from the one consumer task, here the AsyncTCP task
+class AsyncWebMpscQueue
+{
+  private:
+    std::atomic<AsyncWebMpscNode *> _head;
+    AsyncWebMpscNode * _tail;
+    AsyncWebMpscNode _stub;
+    std::atomic<uint32_t> _depth;
+    std::atomic<uint32_t> _dropped;
+    uint32_t _maxDepth;
+
+    /////////////////////////////////////////////////
+
+    inline void _link(AsyncWebMpscNode * node)
+    {
+      node->_mpscNext.store(nullptr, std::memory_order_relaxed);
+      AsyncWebMpscNode * prev = _head.exchange(node, std::memory_order_acq_rel);
+      prev->_mpscNext.store(node, std::memory_order_release);
+    }
+
+  public:
+    AsyncWebMpscQueue(uint32_t maxDepth)
+      : _head(&_stub), _tail(&_stub), _depth(0), _dropped(0), _maxDepth(maxDepth) {}
+
+    /////////////////////////////////////////////////
+
+    ~AsyncWebMpscQueue()
+    {
+      AsyncWebMpscNode * node;
+
+      while ((node = pop()) != nullptr)
+        delete node;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Takes ownership of node. Returns false, and deletes it, once maxDepth items are waiting
+    bool push(AsyncWebMpscNode * node)
+    {
+      if (_depth.fetch_add(1, std::memory_order_relaxed) >= _maxDepth)
+      {
+        _depth.fetch_sub(1, std::memory_order_relaxed);
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+
+        delete node;
+
+        return false;
+      }
+
+      _link(node);
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Consumer only. Returns nullptr when empty, or while a producer is between its two stores
+    AsyncWebMpscNode * pop()
+    {
+      AsyncWebMpscNode * tail = _tail;
+      AsyncWebMpscNode * next = tail->_mpscNext.load(std::memory_order_acquire);
+
+      if (tail == &_stub)
+      {
+        if (next == nullptr)
+          return nullptr;
+
+        _tail = next;
+        tail = next;
+        next = next->_mpscNext.load(std::memory_order_acquire);
+      }
+
+      if (next == nullptr)
+      {
+        if (tail != _head.load(std::memory_order_acquire))
+          return nullptr;
+
+        _link(&_stub);
+
+        next = tail->_mpscNext.load(std::memory_order_acquire);
+
+        if (next == nullptr)
+          return nullptr;
+      }
+
+      _tail = next;
+      _depth.fetch_sub(1, std::memory_order_relaxed);
+
+      return tail;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool isEmpty() const
+    {
+      return _depth.load(std::memory_order_relaxed) == 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Items posted and not yet drained
+    inline uint32_t depth() const
+    {
+      return _depth.load(std::memory_order_relaxed);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Items refused because the queue was full
+    inline uint32_t dropped() const
+    {
+      return _dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/////////////////////////////////////////////////
+
+#endif    // ASYNCWEBMPSCQUEUE_H_
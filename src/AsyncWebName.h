@@ -0,0 +1,130 @@
+/****************************************************************************************************************************
+  AsyncWebName.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBNAME_H_
+#define ASYNCWEBNAME_H_
+
+#include "Arduino.h"
+#include "AsyncWebHeaderId.h"
+
+/////////////////////////////////////////////////
+
+// Name to look up a header or param by, without copying it. Wraps a C string, a String, an F() string
+// or a (pointer, length) slice. On ESP32 flash is memory-mapped, so F() strings are read in place.
+// The hash is awsHeaderHash() (case-insensitive), computed once on first use and compared before the bytes
+class AsyncWebName
+{
+  public:
+    AsyncWebName(const char * name)
+      : _data(name ? name : ""), _len(name ? strlen(name) : 0), _hash(0), _hashed(false) {}
+
+    /////////////////////////////////////////////////
+
+    AsyncWebName(const char * name, size_t len)
+      : _data(name), _len(len), _hash(0), _hashed(false) {}
+
+    /////////////////////////////////////////////////
+
+    AsyncWebName(const String& name)
+      : _data(name.c_str()), _len(name.length()), _hash(0), _hashed(false) {}
+
+    /////////////////////////////////////////////////
+
+    AsyncWebName(const __FlashStringHelper * name)
+      : AsyncWebName(reinterpret_cast<const char *>(name)) {}
+
+    /////////////////////////////////////////////////
+
+    inline const char * c_str() const
+    {
+      return _data;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t length() const
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t hash() const
+    {
+      if (!_hashed)
+      {
+        _hash = awsHeaderHash(_data, _len);
+        _hashed = true;
+      }
+
+      return _hash;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsHeaderId headerId() const
+    {
+      return awsHeaderId(_data, _len);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Param names are case sensitive
+    inline bool equals(const String& name, uint32_t nameHash) const
+    {
+      return (nameHash == hash()) && (name.length() == _len) && !memcmp(name.c_str(), _data, _len);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Header names aren't
+    inline bool equalsIgnoreCase(const char * name, size_t len) const
+    {
+      return (len == _len) && !strncasecmp(name, _data, _len);
+    }
+
+  private:
+    const char * _data;
+    size_t _len;
+    mutable uint32_t _hash;
+    mutable bool _hashed;
+};
+
+#endif /* ASYNCWEBNAME_H_ */
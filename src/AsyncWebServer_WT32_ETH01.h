@@ -90,9 +90,16 @@
 #include "Arduino.h"
 
 #include <functional>
+#include <atomic>
 #include "FS.h"
 
 #include "StringArray.h"
+#include "AsyncWebArena.h"
+#include "AsyncWebHeaderId.h"
+#include "AsyncWebName.h"
+#include "AsyncWebTimerWheel.h"
+#include "AsyncWebWorkerPool.h"
+#include "AsyncWebMetrics.h"
 
 //////////////////////////////////////////////////////////////
 // WT32_ETH01 related code
@@ -179,6 +186,8 @@ class AsyncWebHandler;
 class AsyncStaticWebHandler;
 class AsyncCallbackWebHandler;
 class AsyncResponseStream;
+class AsyncWebUploadSink;
+class AsyncWebTokenAuth;
 
 /////////////////////////////////////////////////
 
@@ -201,6 +210,20 @@ typedef enum
 //if this value is returned when asked for data, packet will not be sent and you will be asked for data again
 #define RESPONSE_TRY_AGAIN      0xFFFFFFFF
 
+// Default request deadlines (ms), see AsyncWebServer::setRequestIdleTimeout() / setRequestHeaderTimeout()
+#ifndef AWS_REQUEST_IDLE_TIMEOUT
+  #define AWS_REQUEST_IDLE_TIMEOUT      3000
+#endif
+
+#ifndef AWS_REQUEST_HEADER_TIMEOUT
+  #define AWS_REQUEST_HEADER_TIMEOUT    10000
+#endif
+
+// Requests with at least this many params get a hash index on the first lookup by name. Below it a list scan is cheaper
+#ifndef AWS_PARAM_INDEX_MIN
+  #define AWS_PARAM_INDEX_MIN           8
+#endif
+
 typedef uint8_t WebRequestMethodComposite;
 typedef std::function<void(void)> ArDisconnectHandler;
 
@@ -218,11 +241,13 @@ class AsyncWebParameter
     size_t _size;
     bool _isForm;
     bool _isFile;
+    uint32_t _hash;
 
   public:
 
     AsyncWebParameter(const String& name, const String& value, bool form = false, bool file = false,
-                      size_t size = 0): _name(name), _value(value), _size(size), _isForm(form), _isFile(file)  {}
+                      size_t size = 0): _name(name), _value(value), _size(size), _isForm(form), _isFile(file),
+      _hash(awsHeaderHash(_name.c_str(), _name.length()))  {}
 
     /////////////////////////////////////////////////
 
@@ -261,6 +286,14 @@ class AsyncWebParameter
 
     /////////////////////////////////////////////////
 
+    // awsHeaderHash() of the name, see AsyncWebName
+    inline uint32_t hash() const
+    {
+      return _hash;
+    }
+
+    /////////////////////////////////////////////////
+
 };
 
 /////////////////////////////////////////////////
@@ -339,9 +372,70 @@ typedef enum
   RCT_MAX
 } RequestedConnectionType;
 
+// Header line kept in the request's arena until a header accessor needs an AsyncWebHeader
+typedef struct AsyncWebRawHeader
+{
+  struct AsyncWebRawHeader * next;
+  const char * name;
+  const char * value;
+  size_t nameLen;
+  uint32_t hash;      // awsHeaderHash() of the name, only set for AWS_HDR_UNKNOWN
+  AwsHeaderId id;
+} AsyncWebRawHeader;
+
+// Query string kept in the request's arena until a param accessor needs the AsyncWebParameters
+typedef struct AsyncWebRawQuery
+{
+  struct AsyncWebRawQuery * next;
+  char * data;
+  size_t len;
+} AsyncWebRawQuery;
+
+// Open addressing slot for a header name that isn't well-known
+typedef struct
+{
+  uint32_t hash;
+  AsyncWebHeader * header;
+} AsyncWebHeaderSlot;
+
+// Built in the request's arena on the first lookup by name
+typedef struct
+{
+  AsyncWebHeader * known[AWS_HDR_COUNT];
+  AsyncWebHeaderSlot * slots;
+  size_t slotMask;
+} AsyncWebHeaderIndex;
+
+// Open addressing slot for a param. Params sharing a name are all kept, in request order
+typedef struct
+{
+  uint32_t hash;
+  AsyncWebParameter * param;
+} AsyncWebParamSlot;
+
+// Built in the request's arena on the first lookup by name, see AWS_PARAM_INDEX_MIN
+typedef struct
+{
+  AsyncWebParamSlot * slots;
+  size_t slotMask;
+  size_t count;
+} AsyncWebParamIndex;
+
 typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
 typedef std::function<String(const String&)> AwsTemplateProcessor;
 
+// Runs on a worker task, see AsyncWebServerRequest::defer()
+typedef std::function<void(AsyncWebServerRequest *request)> ArDeferredHandlerFunction;
+
+typedef enum
+{
+  AWS_DEFER_NONE,
+  AWS_DEFER_QUEUED,           // waiting for a worker
+  AWS_DEFER_RUNNING,          // handler running on a worker
+  AWS_DEFER_DONE,             // response ready for the AsyncTCP task
+  AWS_DEFER_CANCELLED         // client gone, the worker deletes the request
+} AwsDeferState;
+
 /////////////////////////////////////////////////
 
 class AsyncWebServerRequest
@@ -350,12 +444,16 @@ class AsyncWebServerRequest
     using FS = fs::FS;
     friend class AsyncWebServer;
     friend class AsyncCallbackWebHandler;
+    friend class AsyncWebWorkerPool;
 
   private:
     AsyncClient* _client;
     AsyncWebServer* _server;
     AsyncWebHandler* _handler;
     AsyncWebServerResponse* _response;
+    // Headers to keep once a handler is attached: well-known ones as AWS_HDR_BIT()s, others by name
+    uint32_t _interestingMask;
+    bool _interestingAny;
     StringArray _interestingHeaders;
     ArDisconnectHandler _onDisconnectfn;
 
@@ -369,19 +467,52 @@ class AsyncWebServerRequest
     String _contentType;
     String _boundary;
     String _authorization;
+    String _token;
     RequestedConnectionType _reqconntype;
     void _removeNotInterestingHeaders();
     bool _isDigest;
+
+    // Last passing and failing authenticate() credentials, so body / upload chunks don't redo the check.
+    // A digest nonce count can only be used once, so this is also what makes repeated calls pass
+    uint64_t _authPassed;
+    uint64_t _authFailed;
+    bool _authStale;
+
+    bool _authenticate(const char * username, const char * password, const char * realm, bool passwordIsHash);
     bool _isMultipart;
     bool _isPlainPost;
     bool _expectingContinue;
     size_t _contentLength;
     size_t _parsedLength;
 
-    LinkedList<AsyncWebHeader *> _headers;
-    LinkedList<AsyncWebParameter *> _params;
+    mutable LinkedList<AsyncWebHeader *> _headers;
+    mutable LinkedList<AsyncWebParameter *> _params;
     LinkedList<String *> _pathParams;
 
+    // Request head, query and form bytes, freed with the request
+    mutable AsyncWebArena _arena;
+
+    // Headers and query params are only turned into objects on first access
+    mutable AsyncWebRawHeader * _rawHeaders;
+    mutable AsyncWebRawHeader ** _rawHeadersTail;
+    mutable AsyncWebRawQuery * _rawQuery;
+    mutable AsyncWebRawQuery ** _rawQueryTail;
+    bool _headersFiltered;
+    uint32_t _presentHeaders;
+    mutable AsyncWebHeaderIndex * _headerIndex;
+    mutable AsyncWebParamIndex * _paramIndex;
+
+    void _materializeHeaders() const;
+    void _materializeParams() const;
+    void _parseGetParams(char *data, size_t len) const;
+    bool _isInterestingHeader(AwsHeaderId id, const char *name, size_t len) const;
+    const AsyncWebHeaderIndex * _indexHeaders() const;
+    AsyncWebHeader * _findHeader(const AsyncWebName& name) const;
+    bool _hasHeader(const AsyncWebName& name) const;
+    AsyncWebParameter * _findParam(const AsyncWebName& name, bool post, bool file, bool anyKind) const;
+    void _indexParams() const;
+    void _indexParam(AsyncWebParameter * p) const;
+
     uint8_t _multiParseState;
     uint8_t _boundaryPosition;
     size_t _itemStartIndex;
@@ -394,6 +525,34 @@ class AsyncWebServerRequest
     size_t _itemBufferIndex;
     bool _itemIsFile;
 
+    // "\r\n--boundary" and its Boyer-Moore-Horspool skip table, built on the first part body
+    String _delimiter;
+    uint8_t *_delimiterSkip;
+    uint8_t _delimiterMatched;
+
+    AsyncWebTimer _timer;
+    uint32_t _startTime;
+    uint32_t _lastRxTime;
+
+    void _armTimer();
+    void _onTimer();
+
+    ArDeferredHandlerFunction _deferredFn;
+    std::atomic<uint8_t> _deferState;
+    AsyncWebServerResponse* _deferredResponse;
+
+#if AWS_METRICS
+    // For _handler's AsyncWebHandlerMetrics, recorded when the request is deleted. _metricsStart : micros() at accept
+    uint32_t _metricsStart;
+    uint32_t _metricsBytesIn;
+    uint32_t _metricsBytesOut;
+    int _metricsCode;
+#endif
+
+    void _runDeferred();
+    void _completeDeferred();
+    bool _cancelDeferred();
+
     void _onPoll();
     void _onAck(size_t len, uint32_t time);
     void _onError(int8_t error);
@@ -407,8 +566,12 @@ class AsyncWebServerRequest
     bool _parseReqHead();
     bool _parseReqHeader();
     void _parseLine();
-    void _parsePlainPostChar(uint8_t data);
+    void _parsePlainPost(char *data, size_t len);
+    void _addPlainPostPair();
     void _parseMultipartPostByte(uint8_t data, bool last);
+    void _parseMultipart(uint8_t *data, size_t len);
+    size_t _parseMultipartData(uint8_t *data, size_t len);
+    void _writeMultipartData(uint8_t *data, size_t len);
     void _addGetParams(const String& params);
 
     void _handleUploadStart();
@@ -418,10 +581,16 @@ class AsyncWebServerRequest
   public:
     File _tempFile;
     void *_tempObject;
+    AsyncWebUploadSink *_tempSink;        // released with the request, see AsyncWebUploadSink
 
     AsyncWebServerRequest(AsyncWebServer*, AsyncClient*);
     ~AsyncWebServerRequest();
 
+#if AWS_METRICS
+    // Called by responses once the client has acknowledged all of it
+    void _metricsLastAck();
+#endif
+
     /////////////////////////////////////////////////
 
     inline AsyncClient* client()
@@ -431,6 +600,13 @@ class AsyncWebServerRequest
 
     /////////////////////////////////////////////////
 
+    inline AsyncWebServer* server() const
+    {
+      return _server;
+    }
+
+    /////////////////////////////////////////////////
+
     inline uint8_t version() const
     {
       return _version;
@@ -500,6 +676,9 @@ class AsyncWebServerRequest
     // base64(user:pass) for basic or
     // user:realm:md5(user:realm:pass) for digest
     bool authenticate(const char * hash);
+
+    // Bearer token or AWS_TOKEN_COOKIE cookie issued by auth. subject receives the token's subject
+    bool authenticate(const AsyncWebTokenAuth& auth, String * subject = NULL);
     bool authenticate(const char * username, const char * password, const char * realm = NULL, bool passwordIsHash = false);
     void requestAuthentication(const char * realm = NULL, bool isDigest = true);
 
@@ -512,7 +691,28 @@ class AsyncWebServerRequest
 
     /////////////////////////////////////////////////
 
-    void addInterestingHeader(const String& name);
+    void addInterestingHeader(AwsHeaderId id);
+    void addInterestingHeader(const char * name);
+
+    inline void addInterestingHeader(const String& name)
+    {
+      addInterestingHeader(name.c_str());
+    }
+
+    //hand the request to the server's worker pool. fn runs on a worker task and completes the request
+    //with send(), the AsyncTCP task then sends that response on the connection's next ACK or poll, so up
+    //to about 500ms after fn returns on an idle connection. The request stays valid while fn runs, but
+    //fn must not use client(). Returns false if the pool's queue is full
+    bool defer(ArDeferredHandlerFunction fn);
+
+    /////////////////////////////////////////////////
+
+    inline bool deferred() const
+    {
+      return _deferState.load() != AWS_DEFER_NONE;
+    }
+
+    /////////////////////////////////////////////////
 
     void redirect(const String& url);
 
@@ -569,10 +769,12 @@ class AsyncWebServerRequest
     size_t headers() const;                     // get header count
     bool hasHeader(const String& name) const;   // check if header exists
     bool hasHeader(const __FlashStringHelper * data) const;   // check if header exists
+    bool hasHeader(AwsHeaderId id) const;   // check if well-known header exists, O(1)
 
     AsyncWebHeader* getHeader(const String& name) const;
     AsyncWebHeader* getHeader(const __FlashStringHelper * data) const;
     AsyncWebHeader* getHeader(size_t num) const;
+    AsyncWebHeader* getHeader(AwsHeaderId id) const;
 
     size_t params() const;                      // get arguments count
     bool hasParam(const String& name, bool post = false, bool file = false) const;
@@ -603,6 +805,7 @@ class AsyncWebServerRequest
     const String& header(const char* name) const;// get request header value by name
     const String& header(const __FlashStringHelper * data) const;// get request header value by F(name)
     const String& header(size_t i) const;        // get request header value by number
+    const String& header(AwsHeaderId id) const;  // get well-known request header value
     const String& headerName(size_t i) const;    // get request header name by number
     String urlDecode(const String& text) const;
 };
@@ -708,9 +911,27 @@ class AsyncWebHandler
     ArRequestFilterFunction _filter;
     String _username;
     String _password;
+    AsyncWebTokenAuth * _tokenAuth;
+    String _metricsName;
+
+#if AWS_METRICS
+    AsyncWebHandlerMetrics _metrics;
+#endif
+
+    // Route label of the metrics when no name is set, usually the handler's URI
+    virtual String _metricsRoute() const
+    {
+      return String();
+    }
+
+    // Token or credentials, whichever are set. Without either every request is authorized
+    bool _authorized(AsyncWebServerRequest *request);
+
+    // Credentials fall back to the browser's login prompt, a token only handler answers a plain 401
+    void _requestAuthorization(AsyncWebServerRequest *request);
 
   public:
-    AsyncWebHandler(): _username(""), _password("") {}
+    AsyncWebHandler(): _username(""), _password(""), _tokenAuth(NULL) {}
 
     /////////////////////////////////////////////////
 
@@ -731,6 +952,16 @@ class AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // Accept tokens issued by auth, as "Authorization: Bearer" or in the AWS_TOKEN_COOKIE cookie.
+    // Can be combined with setAuthentication(), either then passes. auth must outlive the handler
+    inline AsyncWebHandler& setTokenAuthentication(AsyncWebTokenAuth *auth)
+    {
+      _tokenAuth = auth;
+      return *this;
+    };
+
+    /////////////////////////////////////////////////
+
     inline bool filter(AsyncWebServerRequest *request)
     {
       return _filter == NULL || _filter(request);
@@ -738,6 +969,40 @@ class AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // Route label in AsyncWebMetricsHandler's output, instead of the handler's URI
+    inline AsyncWebHandler& setMetricsName(const String& name)
+    {
+      _metricsName = name;
+      return *this;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline String metricsName() const
+    {
+      return _metricsName.length() ? _metricsName : _metricsRoute();
+    }
+
+#if AWS_METRICS
+
+    /////////////////////////////////////////////////
+
+    inline AsyncWebHandlerMetrics& metrics()
+    {
+      return _metrics;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const AsyncWebHandlerMetrics& metrics() const
+    {
+      return _metrics;
+    }
+
+#endif
+
+    /////////////////////////////////////////////////
+
     virtual ~AsyncWebHandler() {}
 
     /////////////////////////////////////////////////
@@ -803,6 +1068,16 @@ class AsyncWebServerResponse
     AsyncWebServerResponse();
     virtual ~AsyncWebServerResponse();
     virtual void setCode(int code);
+
+    /////////////////////////////////////////////////
+
+    inline int code() const
+    {
+      return _code;
+    }
+
+    /////////////////////////////////////////////////
+
     virtual void setContentLength(size_t len);
     virtual void setContentType(const String& type);
     virtual void addHeader(const String& name, const String& value);
@@ -831,11 +1106,17 @@ ArBodyHandlerFunction;
 
 class AsyncWebServer
 {
+    friend class AsyncWebMetricsHandler;
+
   protected:
     AsyncServer _server;
     LinkedList<AsyncWebRewrite*> _rewrites;
     LinkedList<AsyncWebHandler*> _handlers;
     AsyncCallbackWebHandler* _catchAllHandler;
+    AsyncWebTimerWheel _timers;
+    AsyncWebWorkerPool _workers;
+    uint32_t _requestIdleTimeout;
+    uint32_t _requestHeaderTimeout;
 
   public:
     AsyncWebServer(uint16_t port);
@@ -844,6 +1125,64 @@ class AsyncWebServer
     void begin();
     void end();
 
+    /////////////////////////////////////////////////
+
+    // Keep-alive pings, heartbeats and request deadlines of all connections run on this wheel
+    inline AsyncWebTimerWheel& timers()
+    {
+      return _timers;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Start the worker pool for AsyncWebServerRequest::defer(). Otherwise it starts with the
+    // AWS_WORKER_* defaults on the first defer()
+    inline bool setWorkers(uint8_t count, uint32_t stackSize = AWS_WORKER_STACK_SIZE,
+                           UBaseType_t priority = AWS_WORKER_PRIORITY, BaseType_t core = AWS_WORKER_CORE,
+                           uint8_t queueLength = AWS_WORKER_QUEUE_LENGTH)
+    {
+      return _workers.begin(count, stackSize, priority, core, queueLength);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AsyncWebWorkerPool& workers()
+    {
+      return _workers;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Close a request receiving nothing for ms (0 disables), until its response starts
+    inline void setRequestIdleTimeout(uint32_t ms)
+    {
+      _requestIdleTimeout = ms;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t requestIdleTimeout() const
+    {
+      return _requestIdleTimeout;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Close a request whose headers are not complete ms after connecting (0 disables)
+    inline void setRequestHeaderTimeout(uint32_t ms)
+    {
+      _requestHeaderTimeout = ms;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t requestHeaderTimeout() const
+    {
+      return _requestHeaderTimeout;
+    }
+
+    /////////////////////////////////////////////////
+
 #if ASYNC_TCP_SSL_ENABLED
     void onSslFileRequest(AcSSlFileHandler cb, void* arg);
     void beginSecure(const char *cert, const char *private_key_file, const char *password);
@@ -939,5 +1278,7 @@ class DefaultHeaders
 #include "WebHandlerImpl.h"
 #include "AsyncWebSocket.h"
 #include "AsyncEventSource.h"
+#include "AsyncWebUploadSink.h"
+#include "AsyncWebTokenAuth.h"
 
 #endif /* _AsyncWebServer_WT32_ETH01_H_ */
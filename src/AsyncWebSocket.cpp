@@ -41,10 +41,8 @@
 #include "Arduino.h"
 #include "AsyncWebSocket.h"
 
-#include <libb64/cencode.h>
-
-#include "Crypto/sha1.h"
-#include "Crypto/Hash.h"
+#include "AsyncWebBase64.h"
+#include "AsyncWebHash.h"
 
 /////////////////////////////////////////////////
 
@@ -67,7 +65,9 @@ size_t webSocketSendFrameWindow(AsyncClient *client)
 
 /////////////////////////////////////////////////
 
-size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len)
+// copy = false hands data to lwIP by reference, so it must stay valid until ACKed
+size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len,
+                          bool copy = true)
 {
   if (!client->canSend())
     return 0;
@@ -148,19 +148,14 @@ size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool
         data[i] = data[i] ^ mbuf[i % 4];
     }
 
-    if (client->add((const char *)data, len) != len)
+    if (client->add((const char *)data, len, copy ? ASYNC_WRITE_FLAG_COPY : 0) != len)
     {
       AWS_LOGDEBUG1(F("Error adding data (bytes):"), len);
       return 0;
     }
   }
 
-  if (!client->send())
-  {
-    AWS_LOGDEBUG1(F("Error sending frame (bytes):"), headLen + len);
-    return 0;
-  }
-
+  // Not sent here : AsyncWebSocketClient::_runQueue() flushes once per batch of frames
   return len;
 }
 
@@ -173,8 +168,8 @@ size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer()
   : _data(nullptr)
   , _len(0)
-  , _lock(false)
   , _count(0)
+  , _managed(false)
 {
 }
 
@@ -183,8 +178,8 @@ AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer()
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(uint8_t * data, size_t size)
   : _data(nullptr)
   , _len(size)
-  , _lock(false)
   , _count(0)
+  , _managed(false)
 {
 
   if (!data)
@@ -206,8 +201,8 @@ AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(uint8_t * data, size_t
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(size_t size)
   : _data(nullptr)
   , _len(size)
-  , _lock(false)
   , _count(0)
+  , _managed(false)
 {
   _data = new uint8_t[_len + 1];
 
@@ -222,12 +217,10 @@ AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(size_t size)
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(const AsyncWebSocketMessageBuffer & copy)
   : _data(nullptr)
   , _len(0)
-  , _lock(false)
   , _count(0)
+  , _managed(false)
 {
   _len = copy._len;
-  _lock = copy._lock;
-  _count = 0;
 
   if (_len)
   {
@@ -247,12 +240,10 @@ AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(const AsyncWebSocketMes
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(AsyncWebSocketMessageBuffer && copy)
   : _data(nullptr)
   , _len(0)
-  , _lock(false)
   , _count(0)
+  , _managed(false)
 {
   _len = copy._len;
-  _lock = copy._lock;
-  _count = 0;
 
   if (copy._data)
   {
@@ -359,11 +350,40 @@ class AsyncWebSocketControl
       return _len + 2;
     }
 
+    // A control frame can't be fragmented : it goes in a single add(), or stays unfinished and is retried.
+    // Returns the bytes added, the ones the peer will ACK
     size_t send(AsyncClient *client)
     {
-      _finished = true;
+      uint8_t frame[2 + 4 + 125];
+      size_t n = 0;
+
+      frame[n++] = 0x80 | (_opcode & 0x0F);
+      frame[n++] = (_mask ? 0x80 : 0x00) | _len;
+
+      if (_mask)
+      {
+        uint8_t * key = frame + n;
+
+        for (uint8_t i = 0; i < 4; i++)
+          frame[n++] = rand() % 0xFF;
+
+        for (size_t i = 0; i < _len; i++)
+          frame[n++] = _data[i] ^ key[i % 4];
+      }
+      else if (_len)
+      {
+        memcpy(frame + n, _data, _len);
+        n += _len;
+      }
+
+      if (!client->canSend() || client->space() < n)
+        return 0;
+
+      size_t added = client->add((const char *) frame, n);
+
+      _finished = (added == n);
 
-      return webSocketSendFrame(client, true, _opcode & 0x0F, _mask, _data, _len);
+      return added;
     }
 };
 
@@ -422,16 +442,20 @@ AsyncWebSocketBasicMessage::~AsyncWebSocketBasicMessage()
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketBasicMessage::ack(size_t len, uint32_t time)
+size_t AsyncWebSocketBasicMessage::ack(size_t len, uint32_t time)
 {
   WT32_ETH01_AWS_UNUSED(time);
 
-  _acked += len;
+  size_t extra = ((_acked + len) > _ack) ? (_acked + len - _ack) : 0;
+
+  _acked += len - extra;
 
   if (_sent == _len && _acked == _ack)
   {
     _status = WS_MSG_SENT;
   }
+
+  return extra;
 }
 
 /////////////////////////////////////////////////
@@ -507,6 +531,288 @@ size_t AsyncWebSocketBasicMessage::send(AsyncClient *client)
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
+/*
+   Borrowed (zero-copy) Message
+*/
+
+AsyncWebSocketBorrowedMessage::AsyncWebSocketBorrowedMessage(const uint8_t * data, size_t len, uint8_t opcode,
+                                                             AwsMessageSentHandler onSent)
+  : _data(data)
+  , _len(len)
+  , _sent(0)
+  , _ack(0)
+  , _acked(0)
+  , _onSent(onSent)
+{
+  _opcode = opcode & 0x07;
+
+  // Server to client frames are never masked, and masking would modify the caller's buffer
+  _mask = false;
+  _status = (_data == NULL) ? WS_MSG_ERROR : WS_MSG_SENDING;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketBorrowedMessage::~AsyncWebSocketBorrowedMessage()
+{
+  if (_onSent)
+    _onSent(_data, _len, (_status == WS_MSG_SENT) ? WS_MSG_SENT : WS_MSG_ERROR);
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocketBorrowedMessage::ack(size_t len, uint32_t time)
+{
+  WT32_ETH01_AWS_UNUSED(time);
+
+  size_t extra = ((_acked + len) > _ack) ? (_acked + len - _ack) : 0;
+
+  _acked += len - extra;
+
+  if (_sent == _len && _acked >= _ack)
+  {
+    _status = WS_MSG_SENT;
+  }
+
+  return extra;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocketBorrowedMessage::send(AsyncClient *client)
+{
+  if (_status != WS_MSG_SENDING)
+    return 0;
+
+  if (_acked < _ack)
+  {
+    return 0;
+  }
+
+  if (_sent == _len)
+  {
+    _status = WS_MSG_SENT;
+
+    return 0;
+  }
+
+  size_t toSend = _len - _sent;
+  size_t window = webSocketSendFrameWindow(client);
+
+  if (window < toSend)
+  {
+    toSend = window;
+  }
+
+  _sent += toSend;
+  _ack += toSend + ((toSend < 126) ? 2 : 4);
+
+  bool final = (_sent == _len);
+  uint8_t* dPtr = (uint8_t*)(_data + (_sent - toSend));
+  uint8_t opCode = (toSend && _sent == toSend) ? _opcode : (uint8_t)WS_CONTINUATION;
+
+  size_t sent = webSocketSendFrame(client, final, opCode, false, dPtr, toSend, false);
+
+  if (toSend && sent != toSend)
+  {
+    _sent -= (toSend - sent);
+    _ack -= (toSend - sent);
+  }
+
+  return sent;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Stream Message
+*/
+
+AsyncWebSocketStreamMessage::AsyncWebSocketStreamMessage(fs::File file, uint8_t opcode, AwsMessageSentHandler onSent)
+  : _file(file)
+  , _stream(nullptr)
+  , _len(0)
+  , _sent(0)
+  , _ack(0)
+  , _acked(0)
+  , _buffer(nullptr)
+  , _buffered(0)
+  , _finalSent(false)
+  , _frameByRef(false)
+  , _onSent(onSent)
+{
+  _opcode = opcode & 0x07;
+  _mask = false;
+
+  if (_file && !_file.isDirectory())
+  {
+    _stream = &_file;
+    _len = _file.size() - _file.position();
+    _status = WS_MSG_SENDING;
+  }
+  else
+  {
+    _status = WS_MSG_ERROR;
+  }
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketStreamMessage::AsyncWebSocketStreamMessage(Stream &stream, size_t len, uint8_t opcode,
+                                                         AwsMessageSentHandler onSent)
+  : _stream(&stream)
+  , _len(len)
+  , _sent(0)
+  , _ack(0)
+  , _acked(0)
+  , _buffer(nullptr)
+  , _buffered(0)
+  , _finalSent(false)
+  , _frameByRef(false)
+  , _onSent(onSent)
+{
+  _opcode = opcode & 0x07;
+  _mask = false;
+  _status = WS_MSG_SENDING;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketStreamMessage::~AsyncWebSocketStreamMessage()
+{
+  if (_buffer)
+    free(_buffer);
+
+  if (_file)
+    _file.close();
+
+  if (_onSent)
+    _onSent(NULL, _sent, (_status == WS_MSG_SENT) ? WS_MSG_SENT : WS_MSG_ERROR);
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocketStreamMessage::ack(size_t len, uint32_t time)
+{
+  WT32_ETH01_AWS_UNUSED(time);
+
+  size_t extra = ((_acked + len) > _ack) ? (_acked + len - _ack) : 0;
+
+  _acked += len - extra;
+
+  if (_finalSent && _acked >= _ack)
+  {
+    _status = WS_MSG_SENT;
+  }
+
+  return extra;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocketStreamMessage::send(AsyncClient *client)
+{
+  if (_status != WS_MSG_SENDING)
+    return 0;
+
+  // One frame in flight at a time, so control frames can be interleaved between frames by _runQueue()
+  if (_acked < _ack)
+  {
+    return 0;
+  }
+
+  if (_finalSent)
+  {
+    _status = WS_MSG_SENT;
+
+    return 0;
+  }
+
+  size_t window = webSocketSendFrameWindow(client);
+
+  if (!window)
+    return 0;
+
+  size_t remaining = _len - _sent;
+
+  if (remaining && !_buffer)
+  {
+    _buffer = (uint8_t *) malloc(std::min(remaining, (size_t) WS_MAX_STREAM_FRAME_SIZE));
+
+    if (_buffer == NULL)
+    {
+      AWS_LOGDEBUG("AsyncWebSocketStreamMessage::send: Error malloc frame buffer");
+
+      _status = WS_MSG_ERROR;
+
+      return 0;
+    }
+  }
+
+  // Bytes left in the buffer by a failed send are sent before reading more
+  size_t frameLen = std::min(std::min(remaining, (size_t) WS_MAX_STREAM_FRAME_SIZE), window);
+
+  if (_buffered < frameLen)
+  {
+    size_t need = frameLen - _buffered;
+    bool isFile = (_stream == &_file);
+
+    // readBytes() waits up to the Stream's timeout for missing bytes, on the AsyncTCP task.
+    // A File has them all, any other source only gives what has already arrived
+    if (!isFile)
+    {
+      int avail = _stream->available();
+
+      need = (avail > 0) ? std::min(need, (size_t) avail) : 0;
+    }
+
+    size_t got = need ? _stream->readBytes((char *) _buffer + _buffered, need) : 0;
+
+    _buffered += got;
+
+    // Nothing arrived yet : retried on the next ack or poll
+    if (!isFile && _buffered == 0)
+      return 0;
+
+    if (got == 0 && _buffered == 0)
+    {
+      // Source ended early, close the message with what was sent
+      AWS_LOGDEBUG3("AsyncWebSocketStreamMessage::send: source ended at", _sent, "of", _len);
+
+      _len = _sent;
+    }
+  }
+
+  size_t toSend = std::min(_buffered, frameLen);
+  bool final = ((_sent + toSend) == _len);
+  uint8_t opCode = (_ack == 0) ? _opcode : (uint8_t) WS_CONTINUATION;
+
+  // The buffer is not touched again until the frame is ACKed, unless leftover bytes must be moved down.
+  // A local close meanwhile aborts the connection, see referencesUnacked()
+  bool copy = (_buffered > toSend);
+  size_t sent = webSocketSendFrame(client, final, opCode, false, _buffer, toSend, copy);
+
+  // An empty final frame returns 0 either way, the window check above already made room for it
+  if (sent != toSend)
+    return 0;
+
+  _sent += toSend;
+  _ack += toSend + ((toSend < 126) ? 2 : 4);
+  _finalSent = final;
+  _frameByRef = !copy;
+
+  _buffered -= toSend;
+
+  if (_buffered)
+    memmove(_buffer, _buffer + toSend, _buffered);
+
+  return sent;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
 /*
    AsyncWebSocketMultiMessage Message
 */
@@ -526,7 +832,7 @@ AsyncWebSocketMultiMessage::AsyncWebSocketMultiMessage(AsyncWebSocketMessageBuff
   {
     _WSbuffer = buffer;
 
-    (*_WSbuffer)++;
+    _WSbuffer->retain();
     _data = buffer->get();
     _len = buffer->length();
     _status = WS_MSG_SENDING;
@@ -545,17 +851,19 @@ AsyncWebSocketMultiMessage::~AsyncWebSocketMultiMessage()
 {
   if (_WSbuffer)
   {
-    (*_WSbuffer)--; // decreases the counter.
+    _WSbuffer->release(); // frees the buffer if this was the last reference
   }
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketMultiMessage::ack(size_t len, uint32_t time)
+size_t AsyncWebSocketMultiMessage::ack(size_t len, uint32_t time)
 {
   WT32_ETH01_AWS_UNUSED(time);
 
-  _acked += len;
+  size_t extra = ((_acked + len) > _ack) ? (_acked + len - _ack) : 0;
+
+  _acked += len - extra;
 
   if (_sent >= _len && _acked >= _ack)
   {
@@ -563,6 +871,8 @@ void AsyncWebSocketMultiMessage::ack(size_t len, uint32_t time)
   }
 
   AWS_LOGDEBUG1("AWSMultiMessage::ack: len =", len);
+
+  return extra;
 }
 
 /////////////////////////////////////////////////
@@ -646,15 +956,27 @@ AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebServerRequest *request, Async
 {
   delete  m;
 }))
+, _timer([](void *r)
+{
+  ((AsyncWebSocketClient*)(r))->_onTimer();
+}, this)
 , _tempObject(NULL)
 {
   _client = request->client();
   _server = server;
+  _timers = &request->server()->timers();
   _clientId = _server->_getNextId();
   _status = WS_CONNECTED;
   _pstate = 0;
   _lastMessageTime = millis();
   _keepAlivePeriod = 0;
+  _idleTimeout = _server->idleTimeout() * 1000;
+  _queuePolicy = _server->queuePolicy();
+  _queueLimit = _server->queueLimit();
+  _queuedBytes = 0;
+  memset(&_queueStats, 0, sizeof(_queueStats));
+  _controlUnacked = 0;
+  _corked = false;
   _client->setRxTimeout(0);
 
   _client->onError([](void *r, AsyncClient * c, int8_t error)
@@ -713,19 +1035,23 @@ void AsyncWebSocketClient::_onAck(size_t len, uint32_t time)
 {
   _lastMessageTime = millis();
 
-  if (!_controlQueue.isEmpty())
+  // Control frames only leave when nothing else is in flight, so they are the first bytes acked
+  if (_controlUnacked)
   {
-    auto head = _controlQueue.front();
+    size_t acked = (len < _controlUnacked) ? len : _controlUnacked;
+
+    _controlUnacked -= acked;
+    len -= acked;
 
-    if (head->finished())
+    while (!_controlUnacked && !_controlQueue.isEmpty() && _controlQueue.front()->finished())
     {
-      len -= head->len();
+      auto head = _controlQueue.front();
 
       if (_status == WS_DISCONNECTING && head->opcode() == WS_DISCONNECT)
       {
         _controlQueue.remove(head);
         _status = WS_DISCONNECTED;
-        _client->close(true);
+        _closeConnection();
         return;
       }
 
@@ -733,13 +1059,19 @@ void AsyncWebSocketClient::_onAck(size_t len, uint32_t time)
     }
   }
 
-  if (len && !_messageQueue.isEmpty())
+  // The rest covers the messages of the batch in queue order
+  for (const auto& m : _messageQueue)
   {
-    _messageQueue.front()->ack(len, time);
+    if (!len)
+      break;
+
+    len = m->ack(len, time);
   }
 
-  _server->_cleanBuffers();
   _runQueue();
+
+  // Deliver messages other tasks posted meanwhile
+  _server->_drainPosts();
 }
 
 /////////////////////////////////////////////////
@@ -750,85 +1082,306 @@ void AsyncWebSocketClient::_onPoll()
   {
     _runQueue();
   }
-  else if (_keepAlivePeriod > 0 && _controlQueue.isEmpty() && _messageQueue.isEmpty()
-           && (millis() - _lastMessageTime) >= _keepAlivePeriod)
+
+  // keepAlivePeriod() / idleTimeout() may be set from another task, the timer is only armed from here
+  if (!_timer.armed() && (_keepAlivePeriod || _idleTimeout))
   {
-    ping((uint8_t *)AWSC_PING_PAYLOAD, AWSC_PING_PAYLOAD_LEN);
+    _armTimer();
   }
+
+  // Last, expiring timers may close this client
+  _timers->poll();
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::_runQueue()
+// Fires at the next keep-alive or idle deadline. Traffic only updates _lastMessageTime,
+// the timer re-checks it when it fires
+void AsyncWebSocketClient::_armTimer()
 {
-  while (!_messageQueue.isEmpty() && _messageQueue.front()->finished())
-  {
-    _messageQueue.remove(_messageQueue.front());
-  }
+  uint32_t idle = millis() - _lastMessageTime;
+  uint32_t delay = 0xFFFFFFFF;
 
-  if (!_controlQueue.isEmpty() && (_messageQueue.isEmpty() || _messageQueue.front()->betweenFrames()) &&
-      webSocketSendFrameWindow(_client) > (size_t)(_controlQueue.front()->len() - 1))
+  if (_keepAlivePeriod)
   {
-    _controlQueue.front()->send(_client);
+    // An overdue ping that could not be queued is retried a full period later
+    delay = (idle < _keepAlivePeriod) ? (_keepAlivePeriod - idle) : _keepAlivePeriod;
   }
-  else if (!_messageQueue.isEmpty() && _messageQueue.front()->betweenFrames() && webSocketSendFrameWindow(_client))
-  {
-    _messageQueue.front()->send(_client);
-  }
-}
 
-/////////////////////////////////////////////////
+  if (_idleTimeout)
+  {
+    uint32_t idleDelay = (idle < _idleTimeout) ? (_idleTimeout - idle) : 0;
 
-bool AsyncWebSocketClient::queueIsFull()
-{
-  if ((_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES) || (_status != WS_CONNECTED) )
-    return true;
+    if (idleDelay < delay)
+      delay = idleDelay;
+  }
 
-  return false;
+  if (delay == 0xFFFFFFFF)
+    _timer.cancel();
+  else
+    _timers->schedule(_timer, delay);
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::_queueMessage(AsyncWebSocketMessage *dataMessage)
+void AsyncWebSocketClient::_onTimer()
 {
-  if (dataMessage == NULL)
+  if (_client == NULL)
     return;
 
-  if (_status != WS_CONNECTED)
-  {
-    delete dataMessage;
-    return;
-  }
+  uint32_t idle = millis() - _lastMessageTime;
 
-  if (_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES)
+  if (_idleTimeout && idle >= _idleTimeout)
   {
-    AWS_LOGDEBUG("ERROR: Too many messages queued");
+    AWS_LOGDEBUG1("AsyncWebSocketClient::_onTimer: idle timeout, closing client", _clientId);
 
-    delete dataMessage;
+    _closeConnection();
+
+    return;
   }
-  else
+
+  if (_keepAlivePeriod && idle >= _keepAlivePeriod && _controlQueue.isEmpty() && _messageQueue.isEmpty())
   {
-    _messageQueue.add(dataMessage);
+    ping((uint8_t *)AWSC_PING_PAYLOAD, AWSC_PING_PAYLOAD_LEN);
   }
 
-  if (_client->canSend())
-    _runQueue();
+  _armTimer();
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::_queueControl(AsyncWebSocketControl *controlMessage)
+void AsyncWebSocketClient::_runQueue()
 {
-  if (controlMessage == NULL)
+  while (!_messageQueue.isEmpty() && _messageQueue.front()->finished())
+  {
+    _removeMessage(_messageQueue.front());
+  }
+
+  // Drained only once everything sent before is ACKed, so all that was queued meanwhile leaves
+  // together : several frames per add() round and a single send() per batch
+  if (_controlUnacked || (!_messageQueue.isEmpty() && !_messageQueue.front()->betweenFrames()))
     return;
 
-  _controlQueue.add(controlMessage);
+  bool added = false;
 
-  if (_client->canSend())
-    _runQueue();
-}
+  for (const auto& c : _controlQueue)
+  {
+    if (c->finished())
+      continue;
 
-/////////////////////////////////////////////////
+    if (webSocketSendFrameWindow(_client) <= (size_t)(c->len() - 1))
+      break;
+
+    size_t sent = c->send(_client);
+
+    // Counted only once in the send buffer : unACKed bytes that never leave would stall the queue.
+    // An unsent frame stays in order for the next ack or poll
+    if (!sent)
+      break;
+
+    _controlUnacked += sent;
+    added = true;
+  }
+
+  // No data after a close frame, and none while corked
+  if (_status == WS_CONNECTED && !_corked && !_server->corked())
+  {
+    for (const auto& m : _messageQueue)
+    {
+      if (m->finished() || m->allSent())
+        continue;
+
+      if (!m->betweenFrames() || !webSocketSendFrameWindow(_client))
+        break;
+
+      m->send(_client);
+      added = true;
+
+      // The rest of a partly sent message goes after its ACK, and later messages must not interleave with it
+      if (!m->allSent() && !m->finished())
+        break;
+    }
+  }
+
+  if (added && !_client->send())
+  {
+    AWS_LOGDEBUG1("AsyncWebSocketClient::_runQueue: Error sending batch, client", _clientId);
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Local close of the TCP connection. tcp_close() leaves the pcb retransmitting its unACKed segments, and
+// onDisconnect frees the queued messages right away : frames sent by reference would then be read from
+// memory given back to the caller (onSent) or freed. Aborting drops those segments first
+void AsyncWebSocketClient::_closeConnection()
+{
+  for (const auto& m : _messageQueue)
+  {
+    if (m->referencesUnacked())
+    {
+      AWS_LOGDEBUG1("AsyncWebSocketClient::_closeConnection: aborting, unACKed frames by reference, id =", _clientId);
+
+      _client->abort();
+
+      return;
+    }
+  }
+
+  _client->close(true);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::cork()
+{
+  _corked = true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::uncork()
+{
+  _corked = false;
+
+  if (_client && _client->canSend())
+    _runQueue();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketClient::queueIsFull()
+{
+  if ( (_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES) || (_queuedBytes >= _queueLimit) || (_status != WS_CONNECTED) )
+    return true;
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_removeMessage(AsyncWebSocketMessage *dataMessage)
+{
+  _queuedBytes -= dataMessage->length();
+  _messageQueue.remove(dataMessage);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketClient::_queueOverLimit(size_t len)
+{
+  // An empty queue always accepts, so a message larger than the limit can still be sent
+  if (_messageQueue.isEmpty())
+    return false;
+
+  return ((_queuedBytes + len) > _queueLimit) || (_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES);
+}
+
+/////////////////////////////////////////////////
+
+// Drops the oldest message that has not been put on the wire yet
+bool AsyncWebSocketClient::_dropOldestMessage()
+{
+  for (const auto& m : _messageQueue)
+  {
+    if (!m->started())
+    {
+      _removeMessage(m);
+      _queueStats.droppedOldest++;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_queueMessage(AsyncWebSocketMessage *dataMessage)
+{
+  if (dataMessage == NULL)
+    return;
+
+  if (_status != WS_CONNECTED)
+  {
+    delete dataMessage;
+    return;
+  }
+
+  const size_t len = dataMessage->length();
+
+  if ( (_queuePolicy == AWS_QUEUE_COALESCE) && dataMessage->key() )
+  {
+    for (const auto& m : _messageQueue)
+    {
+      if ( (m->key() == dataMessage->key()) && !m->started() )
+      {
+        _removeMessage(m);
+        _queueStats.coalesced++;
+
+        break;
+      }
+    }
+  }
+
+  if (_queueOverLimit(len))
+  {
+    if (_queuePolicy == AWS_QUEUE_DISCONNECT)
+    {
+      AWS_LOGDEBUG1("AsyncWebSocketClient::_queueMessage: slow consumer, closing id =", _clientId);
+
+      delete dataMessage;
+      _queueStats.disconnects++;
+
+      // Policy violation. The close frame overtakes the queued data at the next frame boundary
+      close(1008);
+
+      return;
+    }
+
+    if (_queuePolicy != AWS_QUEUE_DROP_NEWEST)
+    {
+      while (_queueOverLimit(len) && _dropOldestMessage());
+    }
+
+    // Still over: only messages already on the wire are left, or the policy keeps them
+    if (_queueOverLimit(len) && (_queuePolicy == AWS_QUEUE_DROP_NEWEST || _messageQueue.length() >= WS_MAX_QUEUED_MESSAGES))
+    {
+      AWS_LOGDEBUG("ERROR: Too many messages queued");
+
+      delete dataMessage;
+      _queueStats.droppedNewest++;
+
+      return;
+    }
+  }
+
+  _messageQueue.add(dataMessage);
+  _queuedBytes += len;
+  _queueStats.queued++;
+
+  if (_queuedBytes > _queueStats.maxQueuedBytes)
+    _queueStats.maxQueuedBytes = _queuedBytes;
+
+  if (_client->canSend())
+    _runQueue();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_queueControl(AsyncWebSocketControl *controlMessage)
+{
+  if (controlMessage == NULL)
+    return;
+
+  _controlQueue.add(controlMessage);
+
+  if (_client->canSend())
+    _runQueue();
+}
+
+/////////////////////////////////////////////////
 
 void AsyncWebSocketClient::close(uint16_t code, const char * message)
 {
@@ -889,7 +1442,7 @@ void AsyncWebSocketClient::_onTimeout(uint32_t time)
 {
   WT32_ETH01_AWS_UNUSED(time);
 
-  _client->close(true);
+  _closeConnection();
 }
 
 /////////////////////////////////////////////////
@@ -991,7 +1544,7 @@ void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
         if (_status == WS_DISCONNECTING)
         {
           _status = WS_DISCONNECTED;
-          _client->close(true);
+          _closeConnection();
         }
         else
         {
@@ -1145,9 +1698,19 @@ void AsyncWebSocketClient::text(const __FlashStringHelper *data)
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::text(AsyncWebSocketMessageBuffer * buffer)
+void AsyncWebSocketClient::text(AsyncWebSocketMessageBuffer * buffer, uint32_t key)
 {
-  _queueMessage(new AsyncWebSocketMultiMessage(buffer));
+  if (!buffer)
+    return;
+
+  // A buffer queued nowhere else is freed here if the message is dropped
+  buffer->retain();
+
+  AsyncWebSocketMessage * message = new AsyncWebSocketMultiMessage(buffer);
+  message->setKey(key);
+  _queueMessage(message);
+
+  buffer->release();
 }
 
 /////////////////////////////////////////////////
@@ -1204,9 +1767,46 @@ void AsyncWebSocketClient::binary(const __FlashStringHelper *data, size_t len)
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::binary(AsyncWebSocketMessageBuffer * buffer)
+void AsyncWebSocketClient::binary(AsyncWebSocketMessageBuffer * buffer, uint32_t key)
+{
+  if (!buffer)
+    return;
+
+  buffer->retain();
+
+  AsyncWebSocketMessage * message = new AsyncWebSocketMultiMessage(buffer, WS_BINARY);
+  message->setKey(key);
+  _queueMessage(message);
+
+  buffer->release();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::textNoCopy(const uint8_t * data, size_t len, AwsMessageSentHandler onSent)
+{
+  _queueMessage(new AsyncWebSocketBorrowedMessage(data, len, WS_TEXT, onSent));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::binaryNoCopy(const uint8_t * data, size_t len, AwsMessageSentHandler onSent)
+{
+  _queueMessage(new AsyncWebSocketBorrowedMessage(data, len, WS_BINARY, onSent));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::streamFile(fs::File file, uint8_t opcode, AwsMessageSentHandler onSent)
 {
-  _queueMessage(new AsyncWebSocketMultiMessage(buffer, WS_BINARY));
+  _queueMessage(new AsyncWebSocketStreamMessage(file, opcode, onSent));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::stream(Stream &stream, size_t len, uint8_t opcode, AwsMessageSentHandler onSent)
+{
+  _queueMessage(new AsyncWebSocketStreamMessage(stream, len, opcode, onSent));
 }
 
 /////////////////////////////////////////////////
@@ -1248,10 +1848,17 @@ AsyncWebSocket::AsyncWebSocket(const String& url)
 }))
 , _cNextId(1)
 , _enabled(true)
-, _buffers(LinkedList<AsyncWebSocketMessageBuffer *>([](AsyncWebSocketMessageBuffer *b)
-{
-  delete b;
-}))
+, _queuePolicy(AWS_QUEUE_DROP_NEWEST)
+, _queueLimit(WS_MAX_QUEUED_BYTES)
+, _idleTimeout(0)
+, _corked(false)
+, _posted(WS_MAX_POSTED_MESSAGES)
+, _liveClients(0)
+, _drainTimer([](void *r)
+{
+  ((AsyncWebSocket*)(r))->_onDrainTimer();
+}, this)
+, _timers(NULL)
 {
   _eventHandler = NULL;
 }
@@ -1260,6 +1867,19 @@ AsyncWebSocket::AsyncWebSocket(const String& url)
 
 AsyncWebSocket::~AsyncWebSocket() {}
 
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::uncork()
+{
+  _corked = false;
+
+  for (const auto& c : _clients)
+  {
+    if (c->status() == WS_CONNECTED)
+      c->uncork();
+  }
+}
+
 void AsyncWebSocket::_handleEvent(AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data,
                                   size_t len)
 {
@@ -1273,18 +1893,48 @@ void AsyncWebSocket::_handleEvent(AsyncWebSocketClient * client, AwsEventType ty
 
 void AsyncWebSocket::_addClient(AsyncWebSocketClient * client)
 {
+  // Posted before it joined : to the clients already there, if any
+  _drainPosts();
+
   _clients.add(client);
+  _clientIndex[client->id()] = client;
+  _liveClients.fetch_add(1);
+
+  if (!_drainTimer.armed())
+  {
+    _timers = client->_timers;
+    _timers->schedule(_drainTimer, AWS_TIMER_TICK_MS);
+  }
 }
 
 /////////////////////////////////////////////////
 
 void AsyncWebSocket::_handleDisconnect(AsyncWebSocketClient * client)
 {
+  unsubscribeAll(client->id());
+  _clientIndex.erase(client->id());
 
   _clients.remove_first([ = ](AsyncWebSocketClient * c)
   {
     return c->id() == client->id();
   });
+
+  // Last one gone : free what is still queued, there is nobody left to deliver it to
+  if (_liveClients.fetch_sub(1) == 1)
+  {
+    _drainTimer.cancel();
+    _drainPosts();
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::_onDrainTimer()
+{
+  _drainPosts();
+
+  if (_liveClients.load())
+    _timers->schedule(_drainTimer, AWS_TIMER_TICK_MS);
 }
 
 /////////////////////////////////////////////////
@@ -1327,12 +1977,11 @@ size_t AsyncWebSocket::count() const
 
 AsyncWebSocketClient * AsyncWebSocket::client(uint32_t id)
 {
-  for (const auto &c : _clients)
+  auto it = _clientIndex.find(id);
+
+  if ( (it != _clientIndex.end()) && (it->second->status() == WS_CONNECTED) )
   {
-    if (c->id() == id && c->status() == WS_CONNECTED)
-    {
-      return c;
-    }
+    return it->second;
   }
 
   return nullptr;
@@ -1402,23 +2051,23 @@ void AsyncWebSocket::text(uint32_t id, const char * message, size_t len)
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer * buffer)
+void AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer * buffer, uint32_t key)
 {
   if (!buffer)
     return;
 
-  buffer->lock();
+  // Hold a reference so a client dropping its message can't free the buffer mid fan-out
+  buffer->retain();
 
   for (const auto& c : _clients)
   {
     if (c->status() == WS_CONNECTED)
     {
-      c->text(buffer);
+      c->text(buffer, key);
     }
   }
 
-  buffer->unlock();
-  _cleanBuffers();
+  buffer->release();
 }
 
 /////////////////////////////////////////////////
@@ -1449,21 +2098,68 @@ void AsyncWebSocket::binaryAll(const char * message, size_t len)
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer * buffer)
+void AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer * buffer, uint32_t key)
 {
   if (!buffer)
     return;
 
-  buffer->lock();
+  buffer->retain();
 
   for (const auto& c : _clients)
   {
     if (c->status() == WS_CONNECTED)
-      c->binary(buffer);
+      c->binary(buffer, key);
   }
 
-  buffer->unlock();
-  _cleanBuffers();
+  buffer->release();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::textNoCopy(uint32_t id, const uint8_t * data, size_t len, AwsMessageSentHandler onSent)
+{
+  AsyncWebSocketClient * c = client(id);
+
+  if (c)
+    c->textNoCopy(data, len, onSent);
+  else if (onSent)
+    onSent(data, len, WS_MSG_ERROR);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::binaryNoCopy(uint32_t id, const uint8_t * data, size_t len, AwsMessageSentHandler onSent)
+{
+  AsyncWebSocketClient * c = client(id);
+
+  if (c)
+    c->binaryNoCopy(data, len, onSent);
+  else if (onSent)
+    onSent(data, len, WS_MSG_ERROR);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::streamFile(uint32_t id, fs::File file, uint8_t opcode, AwsMessageSentHandler onSent)
+{
+  AsyncWebSocketClient * c = client(id);
+
+  if (c)
+    c->streamFile(file, opcode, onSent);
+  else if (onSent)
+    onSent(NULL, 0, WS_MSG_ERROR);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::stream(uint32_t id, Stream &stream, size_t len, uint8_t opcode, AwsMessageSentHandler onSent)
+{
+  AsyncWebSocketClient * c = client(id);
+
+  if (c)
+    c->stream(stream, len, opcode, onSent);
+  else if (onSent)
+    onSent(NULL, 0, WS_MSG_ERROR);
 }
 
 /////////////////////////////////////////////////
@@ -1485,8 +2181,6 @@ void AsyncWebSocket::messageAll(AsyncWebSocketMultiMessage *message)
     if (c->status() == WS_CONNECTED)
       c->message(message);
   }
-
-  _cleanBuffers();
 }
 
 /////////////////////////////////////////////////
@@ -1730,6 +2424,318 @@ void AsyncWebSocket::binaryAll(const __FlashStringHelper *message, size_t len)
 
 /////////////////////////////////////////////////
 
+bool AsyncWebSocket::subscribe(uint32_t id, const char * topic)
+{
+  AsyncWebSocketClient * c = client(id);
+
+  if (!c || !topic)
+    return false;
+
+  AsyncWebSocketSubscribers & subs = _topics[topic];
+
+  if (std::find(subs.begin(), subs.end(), c) == subs.end())
+    subs.push_back(c);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::unsubscribe(uint32_t id, const char * topic)
+{
+  if (!topic)
+    return false;
+
+  auto it = _topics.find(topic);
+
+  if (it == _topics.end())
+    return false;
+
+  AsyncWebSocketSubscribers & subs = it->second;
+
+  for (auto sub = subs.begin(); sub != subs.end(); ++sub)
+  {
+    if ((*sub)->id() == id)
+    {
+      subs.erase(sub);
+
+      if (subs.empty())
+        _topics.erase(it);
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::unsubscribeAll(uint32_t id)
+{
+  for (auto it = _topics.begin(); it != _topics.end(); )
+  {
+    AsyncWebSocketSubscribers & subs = it->second;
+
+    subs.erase(std::remove_if(subs.begin(), subs.end(), [id](AsyncWebSocketClient * c)
+    {
+      return c->id() == id;
+    }), subs.end());
+
+    if (subs.empty())
+      it = _topics.erase(it);
+    else
+      ++it;
+  }
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::subscribers(const char * topic) const
+{
+  if (!topic)
+    return 0;
+
+  auto it = _topics.find(topic);
+
+  return (it == _topics.end()) ? 0 : it->second.size();
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::publish(const char * topic, AsyncWebSocketMessageBuffer * buffer, uint32_t key)
+{
+  if (!buffer)
+    return 0;
+
+  size_t sent = 0;
+
+  // Hold a reference so a buffer without subscribers is still freed, and survives the fan-out
+  buffer->retain();
+
+  auto it = topic ? _topics.find(topic) : _topics.end();
+
+  if (it != _topics.end())
+  {
+    for (const auto& c : it->second)
+    {
+      if (c->status() == WS_CONNECTED)
+      {
+        c->text(buffer, key);
+        sent++;
+      }
+    }
+  }
+
+  buffer->release();
+
+  return sent;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::publish(const char * topic, const char * message, size_t len, uint32_t key)
+{
+  // Don't allocate a buffer nobody will send
+  if (!subscribers(topic))
+    return 0;
+
+  return publish(topic, makeBuffer((uint8_t *) message, len), key);
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::publish(const char * topic, const String &message, uint32_t key)
+{
+  return publish(topic, message.c_str(), message.length(), key);
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::publishBinary(const char * topic, AsyncWebSocketMessageBuffer * buffer, uint32_t key)
+{
+  if (!buffer)
+    return 0;
+
+  size_t sent = 0;
+
+  buffer->retain();
+
+  auto it = topic ? _topics.find(topic) : _topics.end();
+
+  if (it != _topics.end())
+  {
+    for (const auto& c : it->second)
+    {
+      if (c->status() == WS_CONNECTED)
+      {
+        c->binary(buffer, key);
+        sent++;
+      }
+    }
+  }
+
+  buffer->release();
+
+  return sent;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncWebSocket::publishBinary(const char * topic, const uint8_t * message, size_t len, uint32_t key)
+{
+  if (!subscribers(topic))
+    return 0;
+
+  return publishBinary(topic, makeBuffer((uint8_t *) message, len), key);
+}
+
+/////////////////////////////////////////////////
+
+// Runs on the posting task: only allocates and pushes, the client lists are left to the AsyncTCP task
+bool AsyncWebSocket::_post(AsyncWebSocketMessageBuffer * buffer, uint8_t opcode, uint32_t id, uint32_t key,
+                           const char * topic)
+{
+  if (!buffer)
+    return false;
+
+  if (!_liveClients.load())
+  {
+    delete buffer;
+
+    return false;
+  }
+
+  AsyncWebSocketPost * post = new AsyncWebSocketPost(buffer, opcode, id, key);
+
+  if (!post)
+  {
+    delete buffer;
+
+    return false;
+  }
+
+  if (topic)
+    post->_topic = topic;
+
+  if (!_posted.push(post))
+  {
+    AWS_LOGDEBUG1("AsyncWebSocket::_post: queue full, depth =", _posted.depth());
+
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postText(uint32_t id, const char * message, size_t len)
+{
+  return id && _post(makeBuffer((uint8_t *) message, len), WS_TEXT, id, 0);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postText(uint32_t id, const String &message)
+{
+  return postText(id, message.c_str(), message.length());
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postBinary(uint32_t id, const uint8_t * message, size_t len)
+{
+  return id && _post(makeBuffer((uint8_t *) message, len), WS_BINARY, id, 0);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postTextAll(const char * message, size_t len, uint32_t key)
+{
+  return _post(makeBuffer((uint8_t *) message, len), WS_TEXT, 0, key);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postTextAll(const String &message, uint32_t key)
+{
+  return postTextAll(message.c_str(), message.length(), key);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postBinaryAll(const uint8_t * message, size_t len, uint32_t key)
+{
+  return _post(makeBuffer((uint8_t *) message, len), WS_BINARY, 0, key);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postPublish(const char * topic, const char * message, size_t len, uint32_t key)
+{
+  return topic && _post(makeBuffer((uint8_t *) message, len), WS_TEXT, 0, key, topic);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocket::postPublishBinary(const char * topic, const uint8_t * message, size_t len, uint32_t key)
+{
+  return topic && _post(makeBuffer((uint8_t *) message, len), WS_BINARY, 0, key, topic);
+}
+
+/////////////////////////////////////////////////
+
+// AsyncTCP task only : from the drain timer, the clients' acks, and as clients join and leave.
+// Without clients, every post is freed undelivered
+void AsyncWebSocket::_drainPosts()
+{
+  AsyncWebMpscNode * node;
+
+  while ((node = _posted.pop()) != nullptr)
+  {
+    AsyncWebSocketPost * post = static_cast<AsyncWebSocketPost *>(node);
+    AsyncWebSocketMessageBuffer * buffer = post->_buffer;
+    bool isText = (post->_opcode == WS_TEXT);
+
+    // Ownership of the buffer passes to the send call below
+    post->_buffer = NULL;
+
+    if (post->_topic.length())
+    {
+      if (isText)
+        publish(post->_topic.c_str(), buffer, post->_key);
+      else
+        publishBinary(post->_topic.c_str(), buffer, post->_key);
+    }
+    else if (!post->_id)
+    {
+      if (isText)
+        textAll(buffer, post->_key);
+      else
+        binaryAll(buffer, post->_key);
+    }
+    else
+    {
+      AsyncWebSocketClient * c = client(post->_id);
+
+      // Referenced for the duration, so a post to a client that is gone frees its buffer
+      buffer->retain();
+
+      if (c && isText)
+        c->text(buffer, post->_key);
+      else if (c)
+        c->binary(buffer, post->_key);
+
+      buffer->release();
+    }
+
+    delete post;
+  }
+}
+
+/////////////////////////////////////////////////
+
 const char * WS_STR_CONNECTION = "Connection";
 const char * WS_STR_UPGRADE    = "Upgrade";
 const char * WS_STR_ORIGIN     = "Origin";
@@ -1749,12 +2755,12 @@ bool AsyncWebSocket::canHandle(AsyncWebServerRequest *request)
   if (request->method() != HTTP_GET || !request->url().equals(_url) || !request->isExpectedRequestedConnType(RCT_WS))
     return false;
 
-  request->addInterestingHeader(WS_STR_CONNECTION);
-  request->addInterestingHeader(WS_STR_UPGRADE);
-  request->addInterestingHeader(WS_STR_ORIGIN);
-  request->addInterestingHeader(WS_STR_VERSION);
-  request->addInterestingHeader(WS_STR_KEY);
-  request->addInterestingHeader(WS_STR_PROTOCOL);
+  request->addInterestingHeader(AWS_HDR_CONNECTION);
+  request->addInterestingHeader(AWS_HDR_UPGRADE);
+  request->addInterestingHeader(AWS_HDR_ORIGIN);
+  request->addInterestingHeader(AWS_HDR_WS_VERSION);
+  request->addInterestingHeader(AWS_HDR_WS_KEY);
+  request->addInterestingHeader(AWS_HDR_WS_PROTOCOL);
 
   return true;
 }
@@ -1763,19 +2769,19 @@ bool AsyncWebSocket::canHandle(AsyncWebServerRequest *request)
 
 void AsyncWebSocket::handleRequest(AsyncWebServerRequest *request)
 {
-  if (!request->hasHeader(WS_STR_VERSION) || !request->hasHeader(WS_STR_KEY))
+  if (!request->hasHeader(AWS_HDR_WS_VERSION) || !request->hasHeader(AWS_HDR_WS_KEY))
   {
     request->send(400);
 
     return;
   }
 
-  if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
+  if (!_authorized(request))
   {
-    return request->requestAuthentication();
+    return _requestAuthorization(request);
   }
 
-  AsyncWebHeader* version = request->getHeader(WS_STR_VERSION);
+  AsyncWebHeader* version = request->getHeader(AWS_HDR_WS_VERSION);
 
   if (version->value().toInt() != 13)
   {
@@ -1786,12 +2792,12 @@ void AsyncWebSocket::handleRequest(AsyncWebServerRequest *request)
     return;
   }
 
-  AsyncWebHeader* key = request->getHeader(WS_STR_KEY);
+  AsyncWebHeader* key = request->getHeader(AWS_HDR_WS_KEY);
   AsyncWebServerResponse *response = new AsyncWebSocketResponse(key->value(), this);
 
-  if (request->hasHeader(WS_STR_PROTOCOL))
+  if (request->hasHeader(AWS_HDR_WS_PROTOCOL))
   {
-    AsyncWebHeader* protocol = request->getHeader(WS_STR_PROTOCOL);
+    AsyncWebHeader* protocol = request->getHeader(AWS_HDR_WS_PROTOCOL);
     //ToDo: check protocol
     response->addHeader(WS_STR_PROTOCOL, protocol->value());
   }
@@ -1807,8 +2813,7 @@ AsyncWebSocketMessageBuffer * AsyncWebSocket::makeBuffer(size_t size)
 
   if (buffer)
   {
-    AsyncWebLockGuard l(_lock);
-    _buffers.add(buffer);
+    buffer->_managed = true;
   }
 
   return buffer;
@@ -1822,8 +2827,7 @@ AsyncWebSocketMessageBuffer * AsyncWebSocket::makeBuffer(uint8_t * data, size_t
 
   if (buffer)
   {
-    AsyncWebLockGuard l(_lock);
-    _buffers.add(buffer);
+    buffer->_managed = true;
   }
 
   return buffer;
@@ -1831,21 +2835,6 @@ AsyncWebSocketMessageBuffer * AsyncWebSocket::makeBuffer(uint8_t * data, size_t
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocket::_cleanBuffers()
-{
-  AsyncWebLockGuard l(_lock);
-
-  for (AsyncWebSocketMessageBuffer * c : _buffers)
-  {
-    if (c && c->canDelete())
-    {
-      _buffers.remove(c);
-    }
-  }
-}
-
-/////////////////////////////////////////////////
-
 AsyncWebSocket::AsyncWebSocketClientLinkedList AsyncWebSocket::getClients() const
 {
   return _clients;
@@ -1865,43 +2854,19 @@ AsyncWebSocketResponse::AsyncWebSocketResponse(const String & key, AsyncWebSocke
   _code = 101;
   _sendContentLength = false;
 
-  uint8_t * hash = (uint8_t*) malloc(HASH_BUFFER_SIZE);
-
-  if (hash == NULL)
-  {
-    _state = RESPONSE_FAILED;
-    return;
-  }
-
-  char * buffer = (char *) malloc(33);
+  uint8_t hash[AWS_SHA1_SIZE];
+  char accept[AWS_BASE64_ENCODED_LEN(AWS_SHA1_SIZE) + 1];
+  AsyncWebHash sha1(AWS_HASH_SHA1);
 
-  if (buffer == NULL)
-  {
-    free(hash);
-    _state = RESPONSE_FAILED;
-    return;
-  }
-
-  sha1_context _ctx;
+  sha1.update(key);
+  sha1.update(WS_STR_UUID, strlen(WS_STR_UUID));
+  sha1.finish(hash);
 
-  (String&) key += WS_STR_UUID;
-
-  sha1_starts(&_ctx);
-  sha1_update(&_ctx, (const unsigned char*) key.c_str(), key.length());
-  sha1_finish(&_ctx, hash);
-  //////
-
-  base64_encodestate _state;
-  base64_init_encodestate(&_state);
-  int len = base64_encode_block((const char *) hash, HASH_BUFFER_SIZE, buffer, &_state);
-  len = base64_encode_blockend((buffer + len), &_state);
+  awsBase64Encode(hash, AWS_SHA1_SIZE, accept);
 
   addHeader(WS_STR_CONNECTION, WS_STR_UPGRADE);
   addHeader(WS_STR_UPGRADE, "websocket");
-  addHeader(WS_STR_ACCEPT, buffer);
-
-  free(buffer);
-  free(hash);
+  addHeader(WS_STR_ACCEPT, accept);
 }
 
 /////////////////////////////////////////////////
@@ -52,9 +52,33 @@
 #include <AsyncTCP.h>
 #define WS_MAX_QUEUED_MESSAGES 32
 
+// Posts from other tasks waiting for the AsyncTCP task, see AsyncWebSocket::postText()
+#ifndef WS_MAX_POSTED_MESSAGES
+  #define WS_MAX_POSTED_MESSAGES      32
+#endif
+
+// Largest frame AsyncWebSocketStreamMessage reads from its source at once
+#ifndef WS_MAX_STREAM_FRAME_SIZE
+  #define WS_MAX_STREAM_FRAME_SIZE    2048
+#endif
+
+// Default per-client send queue limit, see AwsQueuePolicy
+#ifndef WS_MAX_QUEUED_BYTES
+  #define WS_MAX_QUEUED_BYTES    16384
+#endif
+
 #include "AsyncWebServer_WT32_ETH01.h"
 
 #include "AsyncWebSynchronization.h"
+#include "AsyncWebQueuePolicy.h"
+#include "AsyncWebMpscQueue.h"
+
+// After AsyncWebServer_WT32_ETH01.h, which removes Arduino's min/max macros before STL headers
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 /////////////////////////////////////////////////
 
@@ -120,6 +144,11 @@ typedef enum
   WS_MSG_ERROR
 } AwsMessageStatus;
 
+// Called once a caller-owned buffer is no longer referenced by the library or by lwIP, so it may be recycled.
+// status is WS_MSG_SENT when the last byte was ACKed, WS_MSG_ERROR if the message was dropped. A connection the
+// library closes while such frames are unACKed is aborted, not closed, so lwIP has freed them before WS_MSG_ERROR
+typedef std::function<void(const uint8_t * data, size_t len, AwsMessageStatus status)> AwsMessageSentHandler;
+
 typedef enum
 {
   WS_EVT_CONNECT,
@@ -131,13 +160,18 @@ typedef enum
 
 /////////////////////////////////////////////////
 
+// Intrusive, atomically reference-counted payload shared by all client messages of a fan-out.
+// Buffers from AsyncWebSocket::makeBuffer() free themselves when the last reference is released,
+// so a buffer must be handed to at least one text()/binary()/textAll()/binaryAll() call.
+// To pass the same buffer to several clients yourself, hold a reference around the loop with
+// retain()/release() (or lock()/unlock()).
 class AsyncWebSocketMessageBuffer
 {
   private:
     uint8_t * _data;
     size_t _len;
-    bool _lock;
-    uint32_t _count;
+    std::atomic<uint32_t> _count;
+    bool _managed;
 
   public:
     AsyncWebSocketMessageBuffer();
@@ -149,22 +183,20 @@ class AsyncWebSocketMessageBuffer
 
     /////////////////////////////////////////////////
 
-    void operator ++(int i)
+    inline void retain()
     {
-      WT32_ETH01_AWS_UNUSED(i);
-      _count++;
+      _count.fetch_add(1, std::memory_order_relaxed);
     }
 
     /////////////////////////////////////////////////
 
-    void operator --(int i)
+    // Frees a makeBuffer() buffer once the last reference is gone
+    inline void release()
     {
-      WT32_ETH01_AWS_UNUSED(i);
-
-      if (_count > 0)
+      if ( (_count.fetch_sub(1, std::memory_order_acq_rel) == 1) && _managed )
       {
-        _count--;
-      } ;
+        delete this;
+      }
     }
 
     /////////////////////////////////////////////////
@@ -175,14 +207,14 @@ class AsyncWebSocketMessageBuffer
 
     inline void lock()
     {
-      _lock = true;
+      retain();
     }
 
     /////////////////////////////////////////////////
 
     inline void unlock()
     {
-      _lock = false;
+      release();
     }
 
     /////////////////////////////////////////////////
@@ -203,14 +235,7 @@ class AsyncWebSocketMessageBuffer
 
     inline uint32_t count()
     {
-      return _count;
-    }
-
-    /////////////////////////////////////////////////
-
-    inline bool canDelete()
-    {
-      return (!_count && !_lock);
+      return _count.load(std::memory_order_relaxed);
     }
 
     /////////////////////////////////////////////////
@@ -227,11 +252,48 @@ class AsyncWebSocketMessage
     uint8_t _opcode;
     bool _mask;
     AwsMessageStatus _status;
+    uint32_t _key;
 
   public:
-    AsyncWebSocketMessage(): _opcode(WS_TEXT), _mask(false), _status(WS_MSG_ERROR) {}
+    AsyncWebSocketMessage(): _opcode(WS_TEXT), _mask(false), _status(WS_MSG_ERROR), _key(0) {}
     virtual ~AsyncWebSocketMessage() {}
-    virtual void ack(size_t len __attribute__((unused)), uint32_t time __attribute__((unused))) {}
+
+    // Returns the acked bytes past this message's frames, which belong to the next message
+    virtual size_t ack(size_t len __attribute__((unused)), uint32_t time __attribute__((unused)))
+    {
+      return 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Messages with the same non-zero key replace each other under AWS_QUEUE_COALESCE
+    inline uint32_t key() const
+    {
+      return _key;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void setKey(uint32_t key)
+    {
+      _key = key;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Payload bytes, counted against the client's queue limit
+    virtual size_t length() const
+    {
+      return 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // true once any part of the message is on the wire, so it can no longer be dropped
+    virtual bool started() const
+    {
+      return false;
+    }
 
     /////////////////////////////////////////////////
 
@@ -253,6 +315,22 @@ class AsyncWebSocketMessage
     {
       return false;
     }
+
+    /////////////////////////////////////////////////
+
+    // true once every frame has been handed to the socket, so the next message may follow in the same batch
+    virtual bool allSent()
+    {
+      return finished();
+    }
+
+    /////////////////////////////////////////////////
+
+    // true while lwIP holds unACKed frames by reference to memory the message gives back when it is destroyed
+    virtual bool referencesUnacked() const
+    {
+      return false;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -273,6 +351,20 @@ class AsyncWebSocketBasicMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
+    virtual size_t length() const override
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool started() const override
+    {
+      return _sent > 0;
+    }
+
+    /////////////////////////////////////////////////
+
     virtual bool betweenFrames() const override
     {
       return _acked == _ack;
@@ -280,7 +372,14 @@ class AsyncWebSocketBasicMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
-    virtual void ack(size_t len, uint32_t time) override ;
+    virtual bool allSent() override
+    {
+      return (_sent == _len) && _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t ack(size_t len, uint32_t time) override ;
     virtual size_t send(AsyncClient *client) override ;
 };
 
@@ -302,6 +401,74 @@ class AsyncWebSocketMultiMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
+    virtual size_t length() const override
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool started() const override
+    {
+      return _sent > 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool betweenFrames() const override
+    {
+      return _acked == _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool allSent() override
+    {
+      return (_sent >= _len) && _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t ack(size_t len, uint32_t time) override ;
+    virtual size_t send(AsyncClient *client) override ;
+};
+
+/////////////////////////////////////////////////
+
+// Sends a buffer owned by the caller without copying it. The buffer must stay valid and unchanged
+// until onSent is called, which happens exactly once, after the last byte is ACKed or the message is dropped.
+// Either way lwIP no longer points into it then
+class AsyncWebSocketBorrowedMessage: public AsyncWebSocketMessage
+{
+  private:
+    const uint8_t * _data;
+    size_t _len;
+    size_t _sent;
+    size_t _ack;
+    size_t _acked;
+    AwsMessageSentHandler _onSent;
+
+  public:
+    AsyncWebSocketBorrowedMessage(const uint8_t * data, size_t len, uint8_t opcode = WS_TEXT,
+                                  AwsMessageSentHandler onSent = nullptr);
+    virtual ~AsyncWebSocketBorrowedMessage() override;
+
+    /////////////////////////////////////////////////
+
+    virtual size_t length() const override
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool started() const override
+    {
+      return _sent > 0;
+    }
+
+    /////////////////////////////////////////////////
+
     virtual bool betweenFrames() const override
     {
       return _acked == _ack;
@@ -309,7 +476,91 @@ class AsyncWebSocketMultiMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
-    virtual void ack(size_t len, uint32_t time) override ;
+    virtual bool allSent() override
+    {
+      return (_sent == _len) && _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool referencesUnacked() const override
+    {
+      return _acked < _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t ack(size_t len, uint32_t time) override ;
+    virtual size_t send(AsyncClient *client) override ;
+};
+
+/////////////////////////////////////////////////
+
+// Sends a file or len bytes of a Stream as one message, reading a frame at a time inside send().
+// RAM use is one frame buffer whatever the size of the source. A Stream must stay valid until onSent is called.
+// A Stream is never waited on : frames carry what available() reports, and when it has nothing the message
+// resumes on the next ack or poll. It must deliver all len bytes eventually, the client's queue waits for it
+class AsyncWebSocketStreamMessage: public AsyncWebSocketMessage
+{
+  private:
+    fs::File _file;
+    Stream * _stream;
+    size_t _len;
+    size_t _sent;
+    size_t _ack;
+    size_t _acked;
+    uint8_t * _buffer;
+    size_t _buffered;
+    bool _finalSent;
+    bool _frameByRef;       // the frame in flight points into _buffer
+    AwsMessageSentHandler _onSent;
+
+  public:
+    AsyncWebSocketStreamMessage(fs::File file, uint8_t opcode = WS_BINARY, AwsMessageSentHandler onSent = nullptr);
+    AsyncWebSocketStreamMessage(Stream &stream, size_t len, uint8_t opcode = WS_BINARY,
+                                AwsMessageSentHandler onSent = nullptr);
+    virtual ~AsyncWebSocketStreamMessage() override;
+
+    /////////////////////////////////////////////////
+
+    // Data stays in the source until sent, only the frame buffer is held in RAM
+    virtual size_t length() const override
+    {
+      return 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool started() const override
+    {
+      return _ack > 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool betweenFrames() const override
+    {
+      return _acked == _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool allSent() override
+    {
+      return _finalSent;
+    }
+
+    /////////////////////////////////////////////////
+
+    // _buffer is freed with the message
+    virtual bool referencesUnacked() const override
+    {
+      return _frameByRef && (_acked < _ack);
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t ack(size_t len, uint32_t time) override ;
     virtual size_t send(AsyncClient *client) override ;
 };
 
@@ -317,6 +568,8 @@ class AsyncWebSocketMultiMessage: public AsyncWebSocketMessage
 
 class AsyncWebSocketClient
 {
+    friend AsyncWebSocket;
+
   private:
     AsyncClient *_client;
     AsyncWebSocket *_server;
@@ -331,10 +584,28 @@ class AsyncWebSocketClient
 
     uint32_t _lastMessageTime;
     uint32_t _keepAlivePeriod;
+    uint32_t _idleTimeout;
+
+    AsyncWebTimerWheel * _timers;
+    AsyncWebTimer _timer;
+
+    AwsQueuePolicy _queuePolicy;
+    size_t _queueLimit;
+    size_t _queuedBytes;
+    AwsQueueStats _queueStats;
+
+    size_t _controlUnacked;
+    bool _corked;
 
+    bool _queueOverLimit(size_t len);
+    bool _dropOldestMessage();
+    void _removeMessage(AsyncWebSocketMessage *dataMessage);
     void _queueMessage(AsyncWebSocketMessage *dataMessage);
     void _queueControl(AsyncWebSocketControl *controlMessage);
     void _runQueue();
+    void _closeConnection();
+    void _armTimer();
+    void _onTimer();
 
   public:
     void *_tempObject;
@@ -389,6 +660,19 @@ class AsyncWebSocketClient
 
     /////////////////////////////////////////////////
 
+    //hold messages in the queue until uncork(), which sends them in as few segments as possible
+    void cork();
+    void uncork();
+
+    /////////////////////////////////////////////////
+
+    inline bool corked() const
+    {
+      return _corked;
+    }
+
+    /////////////////////////////////////////////////
+
     //set auto-ping period in seconds. disabled if zero (default)
     inline void keepAlivePeriod(uint16_t seconds)
     {
@@ -404,6 +688,58 @@ class AsyncWebSocketClient
 
     /////////////////////////////////////////////////
 
+    //close the connection after seconds without traffic. disabled if zero
+    inline void idleTimeout(uint16_t seconds)
+    {
+      _idleTimeout = seconds * 1000;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint16_t idleTimeout()
+    {
+      return (uint16_t)(_idleTimeout / 1000);
+    }
+
+    /////////////////////////////////////////////////
+
+    //send queue backpressure, maxBytes is the queue limit in payload bytes
+    inline void setQueuePolicy(AwsQueuePolicy policy, size_t maxBytes = WS_MAX_QUEUED_BYTES)
+    {
+      _queuePolicy = policy;
+      _queueLimit = maxBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsQueuePolicy queuePolicy() const
+    {
+      return _queuePolicy;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t queueLimit() const
+    {
+      return _queueLimit;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t queuedBytes() const
+    {
+      return _queuedBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const AwsQueueStats& queueStats() const
+    {
+      return _queueStats;
+    }
+
+    /////////////////////////////////////////////////
+
     //data packets
     inline void message(AsyncWebSocketMessage *message)
     {
@@ -422,7 +758,7 @@ class AsyncWebSocketClient
     void text(char * message);
     void text(const String &message);
     void text(const __FlashStringHelper *data);
-    void text(AsyncWebSocketMessageBuffer *buffer);
+    void text(AsyncWebSocketMessageBuffer *buffer, uint32_t key = 0);
 
     void binary(const char * message, size_t len);
     void binary(const char * message);
@@ -430,13 +766,21 @@ class AsyncWebSocketClient
     void binary(char * message);
     void binary(const String &message);
     void binary(const __FlashStringHelper *data, size_t len);
-    void binary(AsyncWebSocketMessageBuffer *buffer);
+    void binary(AsyncWebSocketMessageBuffer *buffer, uint32_t key = 0);
+
+    // zero-copy: data is owned by the caller until onSent is called
+    void textNoCopy(const uint8_t * data, size_t len, AwsMessageSentHandler onSent = nullptr);
+    void binaryNoCopy(const uint8_t * data, size_t len, AwsMessageSentHandler onSent = nullptr);
+
+    // streamed from the source frame by frame, never loaded into RAM
+    void streamFile(fs::File file, uint8_t opcode = WS_BINARY, AwsMessageSentHandler onSent = nullptr);
+    void stream(Stream &stream, size_t len, uint8_t opcode = WS_BINARY, AwsMessageSentHandler onSent = nullptr);
 
     /////////////////////////////////////////////////
 
     inline bool canSend()
     {
-      return _messageQueue.length() < WS_MAX_QUEUED_MESSAGES;
+      return (_queuedBytes < _queueLimit) && (_messageQueue.length() < WS_MAX_QUEUED_MESSAGES);
     }
 
     /////////////////////////////////////////////////
@@ -457,6 +801,34 @@ AwsEventHandler;
 
 /////////////////////////////////////////////////
 
+// Message posted from another task by AsyncWebSocket::postText() and friends, delivered by the AsyncTCP task
+class AsyncWebSocketPost : public AsyncWebMpscNode
+{
+  public:
+    AsyncWebSocketMessageBuffer * _buffer;
+    String _topic;
+    uint32_t _id;       // 0 for all clients
+    uint32_t _key;
+    uint8_t _opcode;
+
+    AsyncWebSocketPost(AsyncWebSocketMessageBuffer * buffer, uint8_t opcode, uint32_t id, uint32_t key)
+      : _buffer(buffer), _id(id), _key(key), _opcode(opcode) {}
+
+    /////////////////////////////////////////////////
+
+    virtual ~AsyncWebSocketPost() override
+    {
+      // Only set if the post was never delivered
+      if (_buffer)
+      {
+        _buffer->retain();
+        _buffer->release();
+      }
+    }
+};
+
+/////////////////////////////////////////////////
+
 //WebServer Handler implementation that plays the role of a socket server
 class AsyncWebSocket: public AsyncWebHandler
 {
@@ -464,12 +836,37 @@ class AsyncWebSocket: public AsyncWebHandler
     typedef LinkedList<AsyncWebSocketClient *> AsyncWebSocketClientLinkedList;
 
   private:
+    typedef std::vector<AsyncWebSocketClient *> AsyncWebSocketSubscribers;
+
     String _url;
     AsyncWebSocketClientLinkedList _clients;
+    std::unordered_map<uint32_t, AsyncWebSocketClient *> _clientIndex;
+    std::unordered_map<std::string, AsyncWebSocketSubscribers> _topics;
     uint32_t _cNextId;
     AwsEventHandler _eventHandler;
     bool _enabled;
-    AsyncWebLock _lock;
+    AwsQueuePolicy _queuePolicy;
+    size_t _queueLimit;
+    uint32_t _idleTimeout;
+    bool _corked;
+    AsyncWebMpscQueue _posted;
+
+    // Read by the posting tasks : with no client, nothing would drain the queue, so posts are refused
+    std::atomic<uint32_t> _liveClients;
+
+    // Drains _posted every tick while clients are connected, whichever connection advances the wheel
+    AsyncWebTimer _drainTimer;
+    AsyncWebTimerWheel * _timers;
+
+    bool _post(AsyncWebSocketMessageBuffer * buffer, uint8_t opcode, uint32_t id, uint32_t key, const char * topic = NULL);
+    void _onDrainTimer();
+
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return _url;
+    }
 
   public:
     AsyncWebSocket(const String& url);
@@ -498,6 +895,63 @@ class AsyncWebSocket: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    //backpressure policy applied to clients connecting from now on
+    inline void setQueuePolicy(AwsQueuePolicy policy, size_t maxBytes = WS_MAX_QUEUED_BYTES)
+    {
+      _queuePolicy = policy;
+      _queueLimit = maxBytes;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline AwsQueuePolicy queuePolicy() const
+    {
+      return _queuePolicy;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t queueLimit() const
+    {
+      return _queueLimit;
+    }
+
+    /////////////////////////////////////////////////
+
+    //cork all clients, e.g. around a burst of textAll() calls. uncork() also uncorks every client
+    inline void cork()
+    {
+      _corked = true;
+    }
+
+    /////////////////////////////////////////////////
+
+    void uncork();
+
+    /////////////////////////////////////////////////
+
+    inline bool corked() const
+    {
+      return _corked;
+    }
+
+    /////////////////////////////////////////////////
+
+    //idle timeout in seconds applied to clients connecting from now on. disabled if zero (default)
+    inline void setIdleTimeout(uint16_t seconds)
+    {
+      _idleTimeout = seconds * 1000;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint16_t idleTimeout() const
+    {
+      return (uint16_t)(_idleTimeout / 1000);
+    }
+
+    /////////////////////////////////////////////////
+
     bool availableForWriteAll();
     bool availableForWrite(uint32_t id);
 
@@ -533,7 +987,7 @@ class AsyncWebSocket: public AsyncWebHandler
     void textAll(char * message);
     void textAll(const String &message);
     void textAll(const __FlashStringHelper *message); //  need to convert
-    void textAll(AsyncWebSocketMessageBuffer * buffer);
+    void textAll(AsyncWebSocketMessageBuffer * buffer, uint32_t key = 0);
 
     void binary(uint32_t id, const char * message, size_t len);
     void binary(uint32_t id, const char * message);
@@ -548,7 +1002,14 @@ class AsyncWebSocket: public AsyncWebHandler
     void binaryAll(char * message);
     void binaryAll(const String &message);
     void binaryAll(const __FlashStringHelper *message, size_t len);
-    void binaryAll(AsyncWebSocketMessageBuffer * buffer);
+    void binaryAll(AsyncWebSocketMessageBuffer * buffer, uint32_t key = 0);
+
+    void textNoCopy(uint32_t id, const uint8_t * data, size_t len, AwsMessageSentHandler onSent = nullptr);
+    void binaryNoCopy(uint32_t id, const uint8_t * data, size_t len, AwsMessageSentHandler onSent = nullptr);
+
+    void streamFile(uint32_t id, fs::File file, uint8_t opcode = WS_BINARY, AwsMessageSentHandler onSent = nullptr);
+    void stream(uint32_t id, Stream &stream, size_t len, uint8_t opcode = WS_BINARY,
+                AwsMessageSentHandler onSent = nullptr);
 
     void message(uint32_t id, AsyncWebSocketMessage *message);
     void messageAll(AsyncWebSocketMultiMessage *message);
@@ -558,6 +1019,48 @@ class AsyncWebSocket: public AsyncWebHandler
 
     size_t printfAll_P(PGM_P formatP, ...)  __attribute__ ((format (printf, 2, 3)));
 
+    //topic subscriptions. publish() encodes the message once and only queues it to the topic's subscribers,
+    //returning the number of clients it was queued to
+    bool subscribe(uint32_t id, const char * topic);
+    bool unsubscribe(uint32_t id, const char * topic);
+    void unsubscribeAll(uint32_t id);
+    size_t subscribers(const char * topic) const;
+
+    size_t publish(const char * topic, AsyncWebSocketMessageBuffer * buffer, uint32_t key = 0);
+    size_t publish(const char * topic, const char * message, size_t len, uint32_t key = 0);
+    size_t publish(const char * topic, const String &message, uint32_t key = 0);
+    size_t publishBinary(const char * topic, AsyncWebSocketMessageBuffer * buffer, uint32_t key = 0);
+    size_t publishBinary(const char * topic, const uint8_t * message, size_t len, uint32_t key = 0);
+
+    //cross-task sends, safe to call from any task or core. The message is copied into a new buffer and
+    //pushed on a lock-free queue that the AsyncTCP task drains every timer tick (AWS_TIMER_TICK_MS) or on a
+    //client's ack, so the caller never takes a lock or touches the client lists. Return false if the queue is
+    //full or no client is connected
+    bool postText(uint32_t id, const char * message, size_t len);
+    bool postText(uint32_t id, const String &message);
+    bool postBinary(uint32_t id, const uint8_t * message, size_t len);
+    bool postTextAll(const char * message, size_t len, uint32_t key = 0);
+    bool postTextAll(const String &message, uint32_t key = 0);
+    bool postBinaryAll(const uint8_t * message, size_t len, uint32_t key = 0);
+    bool postPublish(const char * topic, const char * message, size_t len, uint32_t key = 0);
+    bool postPublishBinary(const char * topic, const uint8_t * message, size_t len, uint32_t key = 0);
+
+    /////////////////////////////////////////////////
+
+    //posts waiting for the AsyncTCP task
+    inline uint32_t postQueueDepth() const
+    {
+      return _posted.depth();
+    }
+
+    /////////////////////////////////////////////////
+
+    //posts refused because WS_MAX_POSTED_MESSAGES were already waiting
+    inline uint32_t postDropped() const
+    {
+      return _posted.dropped();
+    }
+
     /////////////////////////////////////////////////
 
     //event listener
@@ -578,6 +1081,7 @@ class AsyncWebSocket: public AsyncWebHandler
 
     void _addClient(AsyncWebSocketClient * client);
     void _handleDisconnect(AsyncWebSocketClient * client);
+    void _drainPosts();
     void _handleEvent(AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
     virtual void handleRequest(AsyncWebServerRequest *request) override final;
@@ -585,8 +1089,6 @@ class AsyncWebSocket: public AsyncWebHandler
     //  messagebuffer functions/objects.
     AsyncWebSocketMessageBuffer * makeBuffer(size_t size = 0);
     AsyncWebSocketMessageBuffer * makeBuffer(uint8_t * data, size_t size);
-    LinkedList<AsyncWebSocketMessageBuffer *> _buffers;
-    void _cleanBuffers();
 
     AsyncWebSocketClientLinkedList getClients() const;
 };
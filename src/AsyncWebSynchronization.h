@@ -41,57 +41,224 @@
 #ifndef ASYNCWEBSYNCHRONIZATION_H_
 #define ASYNCWEBSYNCHRONIZATION_H_
 
-// Synchronisation is only available on ESP32, as the ESP8266 isn't using FreeRTOS by default
+// Synchronisation is only available on ESP32, as the ESP8266 isn't using FreeRTOS by default.
+// Other targets (host builds for tests, or with AWS_HOST_BUILD defined) use std::recursive_mutex
 
-#include "AsyncWebServer_WT32_ETH01.h"
+#if defined(ESP32) && !defined(AWS_HOST_BUILD)
+  #define AWS_LOCK_FREERTOS     1
+
+  #include "AsyncWebServer_WT32_ETH01.h"
+#else
+  #define AWS_LOCK_FREERTOS     0
+
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <chrono>
+  #include <mutex>
+#endif
+
+// Set to 1 (as a build flag, for all sources) to count acquisitions, wait and hold times of every AsyncWebLock, see AsyncWebLock::stats()
+#ifndef AWS_LOCK_STATS
+  #define AWS_LOCK_STATS        0
+#endif
+
+/////////////////////////////////////////////////
+
+// Contention counters of an AsyncWebLock, all zero unless AWS_LOCK_STATS is set
+typedef struct
+{
+  uint32_t acquisitions;      // outermost lock() calls
+  uint32_t contended;         // of those, the ones that had to wait for another task
+  uint32_t waitUs;            // total time spent waiting
+  uint32_t maxWaitUs;
+  uint32_t maxHoldUs;         // longest time from outermost lock() to matching unlock()
+} AwsLockStats;
 
 /////////////////////////////////////////////////
 
-// This is the ESP32 version of the Sync Lock, using the FreeRTOS Semaphore
+// Recursive mutex. On ESP32 it is a FreeRTOS recursive mutex, which has priority inheritance:
+// a low priority task holding the lock is raised to the priority of the AsyncTCP task waiting for it.
+// The owning task may lock() again, every lock() must be matched by an unlock(). Not for use from ISRs
 class AsyncWebLock
 {
   private:
+#if AWS_LOCK_FREERTOS
     SemaphoreHandle_t _lock;
-    mutable void *_lockedBy;
+#else
+    mutable std::recursive_mutex _lock;
+#endif
+
+    // Only touched by the owning task
+    mutable uint32_t _depth;
+
+#if AWS_LOCK_STATS
+    mutable AwsLockStats _stats;
+    mutable uint32_t _lockedAt;
+#endif
+
+    /////////////////////////////////////////////////
+
+#if AWS_LOCK_FREERTOS
+
+    inline bool _tryTake() const
+    {
+      return xSemaphoreTakeRecursive(_lock, 0) == pdTRUE;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void _take() const
+    {
+      xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void _give() const
+    {
+      xSemaphoreGiveRecursive(_lock);
+    }
+
+    /////////////////////////////////////////////////
+
+    static inline uint32_t _now()
+    {
+      return (uint32_t) micros();
+    }
+
+#else
+
+    inline bool _tryTake() const
+    {
+      return _lock.try_lock();
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void _take() const
+    {
+      _lock.lock();
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void _give() const
+    {
+      _lock.unlock();
+    }
+
+    /////////////////////////////////////////////////
+
+    static inline uint32_t _now()
+    {
+      return (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>
+             (std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#endif
 
   public:
-    AsyncWebLock()
+    AsyncWebLock() : _depth(0)
     {
-      _lock = xSemaphoreCreateBinary();
-      _lockedBy = NULL;
-      xSemaphoreGive(_lock);
+#if AWS_LOCK_FREERTOS
+      _lock = xSemaphoreCreateRecursiveMutex();
+#endif
+
+#if AWS_LOCK_STATS
+      resetStats();
+      _lockedAt = 0;
+#endif
     }
 
     /////////////////////////////////////////////////
 
     ~AsyncWebLock()
     {
+#if AWS_LOCK_FREERTOS
       vSemaphoreDelete(_lock);
+#endif
     }
 
     /////////////////////////////////////////////////
 
+    // Always succeeds, the bool is kept for AsyncWebLockGuard and existing callers
     bool lock() const
     {
-      extern void *pxCurrentTCB;
+#if AWS_LOCK_STATS
 
-      if (_lockedBy != pxCurrentTCB)
+      if (!_tryTake())
       {
-        xSemaphoreTake(_lock, portMAX_DELAY);
-        _lockedBy = pxCurrentTCB;
+        uint32_t start = _now();
+
+        _take();
+
+        uint32_t waited = _now() - start;
 
-        return true;
+        _stats.contended++;
+        _stats.waitUs += waited;
+
+        if (waited > _stats.maxWaitUs)
+          _stats.maxWaitUs = waited;
       }
 
-      return false;
+      if (_depth++ == 0)
+      {
+        _stats.acquisitions++;
+        _lockedAt = _now();
+      }
+
+#else
+
+      _take();
+      _depth++;
+
+#endif
+
+      return true;
     }
 
     /////////////////////////////////////////////////
 
     void unlock() const
     {
-      _lockedBy = NULL;
-      xSemaphoreGive(_lock);
+#if AWS_LOCK_STATS
+
+      if (--_depth == 0)
+      {
+        uint32_t held = _now() - _lockedAt;
+
+        if (held > _stats.maxHoldUs)
+          _stats.maxHoldUs = held;
+      }
+
+#else
+
+      _depth--;
+
+#endif
+
+      _give();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Snapshot read without taking the lock, fields may be mid-update
+    inline AwsLockStats stats() const
+    {
+#if AWS_LOCK_STATS
+      return _stats;
+#else
+      return AwsLockStats { 0, 0, 0, 0, 0 };
+#endif
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void resetStats() const
+    {
+#if AWS_LOCK_STATS
+      _stats = AwsLockStats { 0, 0, 0, 0, 0 };
+#endif
     }
 };
 
@@ -0,0 +1,202 @@
+/****************************************************************************************************************************
+  AsyncWebTimerWheel.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebServer_WT32_ETH01.h"
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimer::cancel()
+{
+  if (!armed())
+    return;
+
+  _wheel->_unlink(this);
+  _wheel->_stats.pending--;
+  _wheel->_stats.cancelled++;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+AsyncWebTimerWheel::AsyncWebTimerWheel()
+  : _now(0)
+  , _lastMs(millis())
+{
+  memset(_slots, 0, sizeof(_slots));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimerWheel::_unlink(AsyncWebTimer * timer)
+{
+  *timer->_pprev = timer->_next;
+
+  if (timer->_next)
+    timer->_next->_pprev = timer->_pprev;
+
+  timer->_next = nullptr;
+  timer->_pprev = nullptr;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimerWheel::_insert(AsyncWebTimer * timer)
+{
+  uint32_t delta = timer->_expires - _now;
+  uint8_t level = 0;
+
+  if (delta >= (1UL << (AWS_TIMER_WHEEL_BITS * AWS_TIMER_WHEEL_LEVELS)))
+  {
+    timer->_expires = _now + (1UL << (AWS_TIMER_WHEEL_BITS * AWS_TIMER_WHEEL_LEVELS)) - 1;
+    delta = timer->_expires - _now;
+  }
+
+  while ( (level < AWS_TIMER_WHEEL_LEVELS - 1) && (delta >= (1UL << (AWS_TIMER_WHEEL_BITS * (level + 1)))) )
+    level++;
+
+  AsyncWebTimer ** head = &_slots[level][(timer->_expires >> (AWS_TIMER_WHEEL_BITS * level)) & AWS_TIMER_WHEEL_MASK];
+
+  timer->_next = *head;
+
+  if (*head)
+    (*head)->_pprev = &timer->_next;
+
+  *head = timer;
+  timer->_pprev = head;
+}
+
+/////////////////////////////////////////////////
+
+// Moves the timers of the slot that just came due on this level down to lower levels
+void AsyncWebTimerWheel::_cascade(uint8_t level)
+{
+  AsyncWebTimer ** head = &_slots[level][(_now >> (AWS_TIMER_WHEEL_BITS * level)) & AWS_TIMER_WHEEL_MASK];
+
+  while (*head)
+  {
+    AsyncWebTimer * timer = *head;
+
+    _unlink(timer);
+    _insert(timer);
+    _stats.cascaded++;
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimerWheel::_tick(uint32_t nowMs)
+{
+  _now++;
+
+  if ((_now & AWS_TIMER_WHEEL_MASK) == 0)
+  {
+    for (uint8_t level = AWS_TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+    {
+      if ((_now & ((1UL << (AWS_TIMER_WHEEL_BITS * level)) - 1)) == 0)
+        _cascade(level);
+    }
+  }
+
+  AsyncWebTimer ** head = &_slots[0][_now & AWS_TIMER_WHEEL_MASK];
+
+  // Unlinked before the callback, which may re-arm it, cancel others in this slot or delete its owner
+  while (*head)
+  {
+    AsyncWebTimer * timer = *head;
+
+    _unlink(timer);
+    _stats.pending--;
+    _stats.expired++;
+
+    if ((nowMs - _lastMs) > _stats.maxLateMs)
+      _stats.maxLateMs = nowMs - _lastMs;
+
+    if (timer->_callback)
+      timer->_callback(timer->_arg);
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimerWheel::schedule(AsyncWebTimer &timer, uint32_t delayMs)
+{
+  if (timer.armed())
+  {
+    timer._wheel->_unlink(&timer);
+    timer._wheel->_stats.pending--;
+    timer._wheel->_stats.cancelled++;
+  }
+
+  // Counted from the last tick, which may be stale if no connection polled for a while
+  uint32_t ticks = ((millis() - _lastMs) + delayMs + AWS_TIMER_TICK_MS - 1) / AWS_TIMER_TICK_MS;
+
+  timer._wheel = this;
+  timer._expires = _now + ((ticks > 0) ? ticks : 1);
+
+  _insert(&timer);
+
+  _stats.pending++;
+  _stats.scheduled++;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTimerWheel::poll(uint32_t nowMs)
+{
+  uint32_t ticks = (nowMs - _lastMs) / AWS_TIMER_TICK_MS;
+
+  if (_stats.pending == 0)
+  {
+    // Nothing armed, skip the idle ticks in one go
+    _now += ticks;
+    _lastMs += ticks * AWS_TIMER_TICK_MS;
+
+    return;
+  }
+
+  while (ticks--)
+  {
+    _lastMs += AWS_TIMER_TICK_MS;
+    _tick(nowMs);
+  }
+}
+
+/////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/****************************************************************************************************************************
+  AsyncWebTimerWheel.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBTIMERWHEEL_H_
+#define ASYNCWEBTIMERWHEEL_H_
+
+#include "Arduino.h"
+
+/////////////////////////////////////////////////
+
+// Resolution of the timer wheel. Connections poll every ~500ms, so finer ticks don't buy precision
+#ifndef AWS_TIMER_TICK_MS
+  #define AWS_TIMER_TICK_MS         250
+#endif
+
+// 3 levels of 64 slots : 16s, 17min and 18h at 250ms per tick. Longer delays are clamped
+#define AWS_TIMER_WHEEL_BITS        6
+#define AWS_TIMER_WHEEL_SLOTS       (1 << AWS_TIMER_WHEEL_BITS)
+#define AWS_TIMER_WHEEL_MASK        (AWS_TIMER_WHEEL_SLOTS - 1)
+#define AWS_TIMER_WHEEL_LEVELS      3
+
+/////////////////////////////////////////////////
+
+typedef void (*AwsTimerCallback)(void * arg);
+
+typedef struct
+{
+  uint32_t pending;           // timers currently armed
+  uint32_t scheduled;         // schedule() calls
+  uint32_t cancelled;         // armed timers cancelled or rescheduled before expiring
+  uint32_t expired;           // callbacks fired
+  uint32_t cascaded;          // timers moved down a level
+  uint32_t maxLateMs;         // worst delay between due time and firing
+} AwsTimerStats;
+
+class AsyncWebTimerWheel;
+
+/////////////////////////////////////////////////
+
+// Intrusive timer, embedded in the connection object it belongs to. Destroying it cancels it
+class AsyncWebTimer
+{
+    friend class AsyncWebTimerWheel;
+
+  private:
+    AsyncWebTimer * _next;
+    AsyncWebTimer ** _pprev;
+    AsyncWebTimerWheel * _wheel;
+    uint32_t _expires;
+    AwsTimerCallback _callback;
+    void * _arg;
+
+  public:
+    AsyncWebTimer(AwsTimerCallback callback = nullptr, void * arg = nullptr)
+      : _next(nullptr), _pprev(nullptr), _wheel(nullptr), _expires(0), _callback(callback), _arg(arg) {}
+
+    ~AsyncWebTimer()
+    {
+      cancel();
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void setCallback(AwsTimerCallback callback, void * arg)
+    {
+      _callback = callback;
+      _arg = arg;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool armed() const
+    {
+      return _pprev != nullptr;
+    }
+
+    /////////////////////////////////////////////////
+
+    void cancel();
+};
+
+/////////////////////////////////////////////////
+
+// Hierarchical timing wheel shared by all connections of a server. Scheduling and cancelling are O(1),
+// and each tick only visits the timers due in that slot, however many connections are open.
+// Not locked : only use it from AsyncTCP callbacks, where it is advanced from the connections' onPoll
+class AsyncWebTimerWheel
+{
+    friend class AsyncWebTimer;
+
+  private:
+    AsyncWebTimer * _slots[AWS_TIMER_WHEEL_LEVELS][AWS_TIMER_WHEEL_SLOTS];
+    uint32_t _now;
+    uint32_t _lastMs;
+    AwsTimerStats _stats;
+
+    void _insert(AsyncWebTimer * timer);
+    void _unlink(AsyncWebTimer * timer);
+    void _cascade(uint8_t level);
+    void _tick(uint32_t nowMs);
+
+  public:
+    AsyncWebTimerWheel();
+
+    // (Re)arms timer to fire delayMs from now, at least one tick away
+    void schedule(AsyncWebTimer &timer, uint32_t delayMs);
+
+    // Runs every tick elapsed up to nowMs
+    void poll(uint32_t nowMs);
+
+    /////////////////////////////////////////////////
+
+    inline void poll()
+    {
+      poll(millis());
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const AwsTimerStats& stats() const
+    {
+      return _stats;
+    }
+};
+
+/////////////////////////////////////////////////
+
+#endif    // ASYNCWEBTIMERWHEEL_H_
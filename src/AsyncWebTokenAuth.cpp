@@ -0,0 +1,311 @@
+/****************************************************************************************************************************
+  AsyncWebTokenAuth.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebServer_WT32_ETH01.h"
+#include "AsyncWebTokenAuth.h"
+#include "WebAuthentication.h"
+
+#include <time.h>
+
+/////////////////////////////////////////////////
+
+// time() values below this mean the clock hasn't been set yet (before 2020)
+#define AWS_TOKEN_CLOCK_SET     1577836800UL
+
+/////////////////////////////////////////////////
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static inline int8_t hexNibble(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+// Often a global : nothing random is drawn here, the RNG isn't seeded during static construction
+AsyncWebTokenAuth::AsyncWebTokenAuth(uint32_t lifetime)
+  : _lifetime(lifetime), _hasKey(false), _bootId(0), _seeded(false)
+{
+  memset(_ipad, 0, sizeof(_ipad));
+  memset(_opad, 0, sizeof(_opad));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTokenAuth::setKey(const uint8_t * key, size_t len)
+{
+  AsyncWebLockGuard l(_seedLock);
+
+  _setKey(key, len);
+  _hasKey = true;
+}
+
+/////////////////////////////////////////////////
+
+// First issue() / verify() : boot id, and the key unless one was set
+void AsyncWebTokenAuth::_seed() const
+{
+  if (_seeded.load())
+    return;
+
+  AsyncWebLockGuard l(_seedLock);
+
+  if (_seeded.load())
+    return;
+
+  awsRandomFill(&_bootId, sizeof(_bootId));
+
+  if (!_hasKey)
+  {
+    uint8_t key[AWS_SHA256_SIZE];
+
+    awsRandomFill(key, sizeof(key));
+    _setKey(key, sizeof(key));
+
+    memset(key, 0, sizeof(key));
+  }
+
+  _seeded.store(true);
+}
+
+/////////////////////////////////////////////////
+
+// Called with _seedLock held
+void AsyncWebTokenAuth::_setKey(const uint8_t * key, size_t len) const
+{
+  uint8_t hashed[AWS_SHA256_SIZE];
+
+  if (len > AWS_HASH_BLOCK_SIZE)
+  {
+    AsyncWebHash::digest(AWS_HASH_SHA256, key, len, hashed);
+
+    key = hashed;
+    len = AWS_SHA256_SIZE;
+  }
+
+  for (uint8_t i = 0; i < AWS_HASH_BLOCK_SIZE; i++)
+  {
+    uint8_t k = (i < len) ? key[i] : 0;
+
+    _ipad[i] = k ^ 0x36;
+    _opad[i] = k ^ 0x5C;
+  }
+
+  memset(hashed, 0, sizeof(hashed));
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebTokenAuth::_mac(const char * data, size_t len, bool uptime, uint8_t * mac) const
+{
+  uint8_t ipad[AWS_HASH_BLOCK_SIZE];
+  uint8_t opad[AWS_HASH_BLOCK_SIZE];
+  uint32_t bootId;
+
+  _seed();
+
+  {
+    AsyncWebLockGuard l(_seedLock);
+
+    memcpy(ipad, _ipad, sizeof(ipad));
+    memcpy(opad, _opad, sizeof(opad));
+    bootId = _bootId;
+  }
+
+  // Lives for this MAC only, so the SHA-256 accelerator is released on return
+  AsyncWebHash ctx(AWS_HASH_SHA256);
+  uint8_t digest[AWS_SHA256_SIZE];
+
+  ctx.update(ipad, AWS_HASH_BLOCK_SIZE);
+
+  // Random per boot, signed into tokens whose expiry is in uptime so they can't be replayed after a reboot
+  if (uptime)
+    ctx.update(&bootId, sizeof(bootId));
+
+  ctx.update(data, len);
+  ctx.finish(digest);
+
+  ctx.update(opad, AWS_HASH_BLOCK_SIZE);
+  ctx.update(digest, AWS_SHA256_SIZE);
+  ctx.finish(digest);
+
+  memcpy(mac, digest, AWS_TOKEN_MAC_LEN);
+
+  memset(ipad, 0, sizeof(ipad));
+  memset(opad, 0, sizeof(opad));
+}
+
+/////////////////////////////////////////////////
+
+uint32_t AsyncWebTokenAuth::now()
+{
+  time_t t = time(NULL);
+
+  if ((uint32_t) t >= AWS_TOKEN_CLOCK_SET)
+    return (uint32_t) t;
+
+  return millis() / 1000;
+}
+
+/////////////////////////////////////////////////
+
+String AsyncWebTokenAuth::issue(const String& subject, uint32_t lifetime) const
+{
+  uint32_t expiry = now() + (lifetime ? lifetime : _lifetime);
+  size_t len = subject.length() * 2 + 1 + 8;
+  String token;
+
+  if (!token.reserve(len + 1 + AWS_TOKEN_MAC_LEN * 2))
+    return String();
+
+  for (size_t i = 0; i < subject.length(); i++)
+  {
+    token.concat(hexDigits[(uint8_t) subject[i] >> 4]);
+    token.concat(hexDigits[(uint8_t) subject[i] & 0x0F]);
+  }
+
+  token.concat('.');
+
+  for (int8_t shift = 28; shift >= 0; shift -= 4)
+    token.concat(hexDigits[(expiry >> shift) & 0x0F]);
+
+  uint8_t mac[AWS_TOKEN_MAC_LEN];
+
+  _mac(token.c_str(), len, (expiry < AWS_TOKEN_CLOCK_SET), mac);
+
+  token.concat('.');
+
+  for (uint8_t i = 0; i < AWS_TOKEN_MAC_LEN; i++)
+  {
+    token.concat(hexDigits[mac[i] >> 4]);
+    token.concat(hexDigits[mac[i] & 0x0F]);
+  }
+
+  return token;
+}
+
+/////////////////////////////////////////////////
+
+String AsyncWebTokenAuth::cookie(const String& token) const
+{
+  String c = AWS_TOKEN_COOKIE "=";
+
+  c.concat(token);
+  c.concat("; Path=/; Max-Age=");
+  c.concat(_lifetime);
+  c.concat("; HttpOnly; SameSite=Strict");
+
+  return c;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebTokenAuth::verify(const char * token, size_t len, String * subject) const
+{
+  if (!token || len < (1 + 8 + 1 + AWS_TOKEN_MAC_LEN * 2))
+    return false;
+
+  size_t signedLen = len - (1 + AWS_TOKEN_MAC_LEN * 2);
+  const char * macHex = token + signedLen + 1;
+  const char * expiryHex = token + signedLen - 8;
+  size_t subjectLen = signedLen - 9;
+
+  if (token[signedLen] != '.' || expiryHex[-1] != '.' || (subjectLen & 1))
+    return false;
+
+  uint32_t expiry = 0;
+
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    int8_t n = hexNibble(expiryHex[i]);
+
+    if (n < 0)
+      return false;
+
+    expiry = (expiry << 4) | n;
+  }
+
+  uint8_t mac[AWS_TOKEN_MAC_LEN];
+  uint8_t diff = 0;
+
+  _mac(token, signedLen, (expiry < AWS_TOKEN_CLOCK_SET), mac);
+
+  for (uint8_t i = 0; i < AWS_TOKEN_MAC_LEN; i++)
+  {
+    int8_t hi = hexNibble(macHex[i * 2]);
+    int8_t lo = hexNibble(macHex[i * 2 + 1]);
+
+    diff |= (uint8_t) (hi | lo) >> 7;
+    diff |= mac[i] ^ (uint8_t) ((hi << 4) | (lo & 0x0F));
+  }
+
+  if (diff)
+    return false;
+
+  // A wall clock expiry can't be checked against uptime, and the other way round the token has expired
+  uint32_t t = now();
+
+  if ((expiry >= AWS_TOKEN_CLOCK_SET) != (t >= AWS_TOKEN_CLOCK_SET) || expiry < t)
+    return false;
+
+  if (subject)
+  {
+    *subject = String();
+
+    if (!subject->reserve(subjectLen / 2))
+      return false;
+
+    for (size_t i = 0; i < subjectLen; i += 2)
+      subject->concat((char) ((hexNibble(token[i]) << 4) | hexNibble(token[i + 1])));
+  }
+
+  return true;
+}
@@ -0,0 +1,136 @@
+/****************************************************************************************************************************
+  AsyncWebTokenAuth.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBTOKENAUTH_H_
+#define ASYNCWEBTOKENAUTH_H_
+
+#include "AsyncWebServer_WT32_ETH01.h"
+
+#include "AsyncWebHash.h"
+#include "AsyncWebSynchronization.h"
+
+#include <atomic>
+
+/////////////////////////////////////////////////
+
+// Seconds a token stays valid, see AsyncWebTokenAuth::setLifetime()
+#ifndef AWS_TOKEN_LIFETIME
+  #define AWS_TOKEN_LIFETIME        3600
+#endif
+
+// Cookie the token is read from when there is no "Authorization: Bearer" header
+#ifndef AWS_TOKEN_COOKIE
+  #define AWS_TOKEN_COOKIE          "aws_token"
+#endif
+
+// Bytes of HMAC-SHA256 kept in a token
+#define AWS_TOKEN_MAC_LEN           16
+
+/////////////////////////////////////////////////
+
+// Stateless session tokens : hex(subject) "." hex(expiry) "." hex(HMAC-SHA256(key, first two parts)).
+// Issue one after a login checked with authenticate(), then hand it to the browser as a cookie or to an API
+// client as a bearer token. Checking it is one HMAC over the precomputed key pads, without server state or heap use.
+// Expiry uses time() once the clock is set (SNTP), uptime before that. Uptime tokens are tied to the boot they were
+// issued in. The default key is random per boot; a key set with setKey() keeps wall clock tokens valid across reboots.
+// The random key and boot id are only drawn on the first issue() / verify(), once the entropy source can be used
+class AsyncWebTokenAuth
+{
+  private:
+    // HMAC key pads. Kept as bytes rather than as hashes of them : a SHA-256 context that has processed a block
+    // holds the accelerator until it is finished, so only short-lived contexts in _mac() may use it
+    mutable uint8_t _ipad[AWS_HASH_BLOCK_SIZE];
+    mutable uint8_t _opad[AWS_HASH_BLOCK_SIZE];
+    uint32_t _lifetime;
+    bool _hasKey;
+
+    mutable uint32_t _bootId;
+    mutable std::atomic<bool> _seeded;
+    // Guards the pads and boot id, which setKey() may change while another task checks a token
+    mutable AsyncWebLock _seedLock;
+
+    void _seed() const;
+    void _setKey(const uint8_t * key, size_t len) const;
+    void _mac(const char * data, size_t len, bool uptime, uint8_t * mac) const;
+
+  public:
+    AsyncWebTokenAuth(uint32_t lifetime = AWS_TOKEN_LIFETIME);
+
+    void setKey(const uint8_t * key, size_t len);
+
+    /////////////////////////////////////////////////
+
+    inline void setLifetime(uint32_t seconds)
+    {
+      _lifetime = seconds;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t lifetime() const
+    {
+      return _lifetime;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Token for subject (e.g. the user name) valid for lifetime seconds, or the default lifetime when 0
+    String issue(const String& subject, uint32_t lifetime = 0) const;
+
+    // Set-Cookie value carrying token, HttpOnly and SameSite=Strict
+    String cookie(const String& token) const;
+
+    // Constant-time check of the MAC, then of the expiry. subject receives the token's subject
+    bool verify(const char * token, size_t len, String * subject = NULL) const;
+
+    /////////////////////////////////////////////////
+
+    inline bool verify(const String& token, String * subject = NULL) const
+    {
+      return verify(token.c_str(), token.length(), subject);
+    }
+
+    /////////////////////////////////////////////////
+
+    // time() when the clock is set, else seconds since boot
+    static uint32_t now();
+};
+
+#endif /* ASYNCWEBTOKENAUTH_H_ */
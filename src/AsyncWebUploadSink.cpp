@@ -0,0 +1,317 @@
+/****************************************************************************************************************************
+  AsyncWebUploadSink.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncWebUploadSink.h"
+
+/////////////////////////////////////////////////
+
+AsyncWebUploadSink::AsyncWebUploadSink(fs::File file, size_t sectorSize)
+  : _file(file)
+  , _size(sectorSize)
+  , _fill(0)
+  , _active(0)
+  , _flushBuffer(NULL)
+  , _flushLen(0)
+  , _tail(NULL)
+  , _tailLen(0)
+  , _written(0)
+  , _failed(false)
+  , _stopping(false)
+  , _closed(false)
+  , _refs(1)
+  , _work(NULL)
+  , _exited(NULL)
+  , _task(NULL)
+  , _client(NULL)
+  , _withholding(false)
+{
+  _buffers[0] = (uint8_t *) malloc(_size + AWS_UPLOAD_WINDOW);
+  _buffers[1] = (uint8_t *) malloc(_size + AWS_UPLOAD_WINDOW);
+
+  _work = xSemaphoreCreateBinary();
+  _exited = xSemaphoreCreateBinary();
+
+  if (!_file || !_buffers[0] || !_buffers[1] || !_work || !_exited)
+  {
+    AWS_LOGERROR(F("[AsyncWebUploadSink] Error allocating buffers"));
+
+    return;
+  }
+
+  // The writer task's reference
+  _refs.store(2);
+
+  if (xTaskCreatePinnedToCore(_run, "aws_upload", AWS_UPLOAD_TASK_STACK_SIZE, this, AWS_UPLOAD_TASK_PRIORITY,
+                              &_task, tskNO_AFFINITY) != pdPASS)
+  {
+    AWS_LOGERROR(F("[AsyncWebUploadSink] Error creating writer task"));
+
+    _task = NULL;
+    _refs.store(1);
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Last reference gone : the writer task, if any, has exited
+AsyncWebUploadSink::~AsyncWebUploadSink()
+{
+  if (_file)
+    _file.close();
+
+  free(_buffers[0]);
+  free(_buffers[1]);
+
+  if (_work)
+    vSemaphoreDelete(_work);
+
+  if (_exited)
+    vSemaphoreDelete(_exited);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebUploadSink::release()
+{
+  // The request, and its client, are on their way out
+  _client = NULL;
+  _withholding = false;
+
+  _requestStop();
+  _unref();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebUploadSink::write(AsyncWebServerRequest * request, const uint8_t * data, size_t len)
+{
+  if (!_task || _failed.load() || _stopping.load())
+    return false;
+
+  if (_fill + len > _size + AWS_UPLOAD_WINDOW)
+  {
+    AWS_LOGERROR1(F("[AsyncWebUploadSink] Data past the withheld window, AWS_UPLOAD_WINDOW ="), AWS_UPLOAD_WINDOW);
+
+    _failed.store(true);
+
+    return false;
+  }
+
+  memcpy(_buffers[_active] + _fill, data, len);
+  _fill += len;
+
+  _client = request->client();
+
+  if ((_fill >= _size) && !_flushLen.load())
+    _submit();
+
+  if (_fill >= _size)
+  {
+    // Both sectors full : hold this segment's window until the writer task is done
+    if (_client)
+    {
+      _client->ackLater();
+      _withholding = true;
+    }
+  }
+  else
+  {
+    poll();
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebUploadSink::poll()
+{
+  if (!_stopping.load() && (_fill >= _size) && !_flushLen.load())
+    _submit();
+
+  // Room for a full window again
+  if (_client && _withholding && (_stopping.load() || (_fill < _size)))
+  {
+    _client->ack(0xFFFFFFFF);
+    _withholding = false;
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebUploadSink::close()
+{
+  if (!_task || _stopping.load())
+    return false;
+
+  _tail = _buffers[_active];
+  _tailLen = _fill;
+  _fill = 0;
+
+  _requestStop();
+
+  if (_client && _withholding)
+    _client->ack(0xFFFFFFFF);
+
+  _client = NULL;
+  _withholding = false;
+
+  return !_failed.load();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebUploadSink::wait(uint32_t timeoutMs)
+{
+  if (!_task || !_stopping.load())
+    return false;
+
+  if (xSemaphoreTake(_exited, pdMS_TO_TICKS(timeoutMs)) != pdTRUE)
+  {
+    AWS_LOGERROR(F("[AsyncWebUploadSink] Timeout waiting for flash"));
+
+    return false;
+  }
+
+  // For any other waiter
+  xSemaphoreGive(_exited);
+
+  return !_failed.load();
+}
+
+/////////////////////////////////////////////////
+
+// Hands the first _size bytes of the active buffer to the idle writer task, the rest moves to the other buffer
+void AsyncWebUploadSink::_submit()
+{
+  uint8_t * full = _buffers[_active];
+  size_t rest = _fill - _size;
+
+  _active ^= 1;
+
+  if (rest)
+    memcpy(_buffers[_active], full + _size, rest);
+
+  _fill = rest;
+
+  _flushBuffer = full;
+  _flushLen.store(_size);
+
+  xSemaphoreGive(_work);
+}
+
+/////////////////////////////////////////////////
+
+// Never waits : the writer task finishes its sector and the tail, if any, and exits on its own
+void AsyncWebUploadSink::_requestStop()
+{
+  if (!_task)
+    return;
+
+  _stopping.store(true);
+  xSemaphoreGive(_work);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebUploadSink::_unref()
+{
+  if (_refs.fetch_sub(1) == 1)
+    delete this;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebUploadSink::_run(void * arg)
+{
+  AsyncWebUploadSink * sink = (AsyncWebUploadSink *) arg;
+
+  while (xSemaphoreTake(sink->_work, portMAX_DELAY) == pdTRUE)
+  {
+    size_t len = sink->_flushLen.load();
+
+    if (len)
+    {
+      size_t done = sink->_file.write(sink->_flushBuffer, len);
+
+      if (done != len)
+      {
+        AWS_LOGERROR1(F("[AsyncWebUploadSink] Short write"), done);
+
+        sink->_failed.store(true);
+      }
+
+      sink->_written.fetch_add(done);
+
+      // Seen by write() / poll() on the AsyncTCP task, which hand the next sector over and reopen the window
+      sink->_flushLen.store(0);
+    }
+
+    if (sink->_stopping.load())
+    {
+      // Set by close() before _stopping, 0 after release()
+      if (sink->_tailLen && !sink->_failed.load())
+      {
+        size_t done = sink->_file.write(sink->_tail, sink->_tailLen);
+
+        if (done != sink->_tailLen)
+        {
+          AWS_LOGERROR1(F("[AsyncWebUploadSink] Short write"), done);
+
+          sink->_failed.store(true);
+        }
+
+        sink->_written.fetch_add(done);
+      }
+
+      break;
+    }
+  }
+
+  sink->_file.close();
+  sink->_closed.store(true);
+
+  xSemaphoreGive(sink->_exited);
+
+  // May free the sink
+  sink->_unref();
+
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,182 @@
+/****************************************************************************************************************************
+  AsyncWebUploadSink.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBUPLOADSINK_H_
+#define ASYNCWEBUPLOADSINK_H_
+
+#include "AsyncWebServer_WT32_ETH01.h"
+
+#include <atomic>
+
+/////////////////////////////////////////////////
+
+// Flash erase sector. Uploads reach the file system in writes of this size
+#ifndef AWS_UPLOAD_SECTOR_SIZE
+  #define AWS_UPLOAD_SECTOR_SIZE        4096
+#endif
+
+#ifndef AWS_UPLOAD_TASK_STACK_SIZE
+  #define AWS_UPLOAD_TASK_STACK_SIZE    4096
+#endif
+
+#ifndef AWS_UPLOAD_TASK_PRIORITY
+  #define AWS_UPLOAD_TASK_PRIORITY      2
+#endif
+
+// Slack after each sector buffer for what the peer may still send once the window is withheld : the TCP receive window
+#ifndef AWS_UPLOAD_WINDOW
+  #ifdef CONFIG_TCP_WND_DEFAULT
+    #define AWS_UPLOAD_WINDOW           CONFIG_TCP_WND_DEFAULT
+  #else
+    #define AWS_UPLOAD_WINDOW           5744
+  #endif
+#endif
+
+// Longest SPIFFSEditor's worker waits (ms) for the last sector to reach flash before answering 500
+#ifndef AWS_UPLOAD_FINISH_TIMEOUT
+  #define AWS_UPLOAD_FINISH_TIMEOUT     10000
+#endif
+
+/////////////////////////////////////////////////
+
+// Double-buffered upload writer. write() copies into one sector buffer while a background task writes
+// the other to the file. Only when the free buffer is full too, with the other sector still on its way to
+// flash, are received segments not acknowledged (AsyncClient::ackLater()), so the TCP window closes instead
+// of the data piling up; what the peer had already sent lands in the AWS_UPLOAD_WINDOW slack. A slow flash
+// (e.g. SPIFFS garbage collection) only keeps the window closed longer, it never fails the upload.
+// The writer task only clears _flushLen once the flash is done; the next sector is handed over and the window
+// reopened from the AsyncTCP task, on the next write() or the request's poll, as AsyncClient isn't safe to use
+// from another task. All methods except wait() belong to the AsyncTCP task. The request owns the sink through
+// release(); the writer task holds a second reference, so a slow sector can finish after the request is gone
+class AsyncWebUploadSink
+{
+  private:
+    fs::File _file;
+    uint8_t * _buffers[2];
+    size_t _size;
+    size_t _fill;
+    uint8_t _active;
+
+    // Sector handed to the writer task, _flushLen is 0 once it is on flash
+    uint8_t * _flushBuffer;
+    std::atomic<size_t> _flushLen;
+
+    // Partial last sector, handed over by close() and written by the task before it exits
+    uint8_t * _tail;
+    size_t _tailLen;
+
+    std::atomic<size_t> _written;
+    std::atomic<bool> _failed;
+    std::atomic<bool> _stopping;
+    std::atomic<bool> _closed;
+    std::atomic<uint8_t> _refs;
+
+    SemaphoreHandle_t _work;
+    SemaphoreHandle_t _exited;
+    TaskHandle_t _task;
+
+    AsyncClient * _client;
+    bool _withholding;
+
+    void _submit();
+    void _requestStop();
+    void _unref();
+    static void _run(void * sink);
+
+    // Only through release()
+    ~AsyncWebUploadSink();
+
+  public:
+    AsyncWebUploadSink(fs::File file, size_t sectorSize = AWS_UPLOAD_SECTOR_SIZE);
+
+    // Drops the owner's reference, e.g. from the request's destructor. Unwritten data is dropped, a sector
+    // already being written is finished by the writer task, which then closes the file and frees the sink
+    void release();
+
+    // Buffers and writer task are available
+    inline bool ok() const
+    {
+      return _task != NULL;
+    }
+
+    /////////////////////////////////////////////////
+
+    // From handleUpload() / onUpload(). Never waits. Returns false once the upload failed, on a write error
+    // or if the peer sent more than AWS_UPLOAD_WINDOW past a withheld window
+    bool write(AsyncWebServerRequest * request, const uint8_t * data, size_t len);
+
+    // Hands the next sector over and reopens a withheld window once the writer task is done. From the request's poll
+    void poll();
+
+    // Hands the partial last sector to the writer task, which writes it and closes the file. Never waits :
+    // closed() tells when that is done, and wait() waits for it from another task. Returns false if already failed
+    bool close();
+
+    // From a worker task (never the AsyncTCP task) after close() : waits up to timeoutMs for the file to be
+    // written and closed. Returns false on a write error or timeout
+    bool wait(uint32_t timeoutMs);
+
+    /////////////////////////////////////////////////
+
+    // The writer task wrote everything handed over and closed the file
+    inline bool closed() const
+    {
+      return _closed.load();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Bytes on flash so far
+    inline size_t written() const
+    {
+      return _written.load();
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool failed() const
+    {
+      return _failed.load();
+    }
+};
+
+/////////////////////////////////////////////////
+
+#endif    // ASYNCWEBUPLOADSINK_H_
@@ -0,0 +1,124 @@
+/****************************************************************************************************************************
+  AsyncWebWorkerPool.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef ASYNCWEBWORKERPOOL_H_
+#define ASYNCWEBWORKERPOOL_H_
+
+#include "Arduino.h"
+
+/////////////////////////////////////////////////
+
+// Defaults of the pool running deferred handlers, see AsyncWebServer::setWorkers()
+#ifndef AWS_WORKER_COUNT
+  #define AWS_WORKER_COUNT          1
+#endif
+
+#ifndef AWS_WORKER_STACK_SIZE
+  #define AWS_WORKER_STACK_SIZE     4096
+#endif
+
+// Below the AsyncTCP task, so slow handlers never delay the network
+#ifndef AWS_WORKER_PRIORITY
+  #define AWS_WORKER_PRIORITY       2
+#endif
+
+#ifndef AWS_WORKER_CORE
+  #define AWS_WORKER_CORE           tskNO_AFFINITY
+#endif
+
+// Deferred requests waiting for a free worker. defer() fails beyond that
+#ifndef AWS_WORKER_QUEUE_LENGTH
+  #define AWS_WORKER_QUEUE_LENGTH   8
+#endif
+
+class AsyncWebServerRequest;
+
+/////////////////////////////////////////////////
+
+// Fixed set of FreeRTOS tasks running AsyncWebServerRequest::defer() handlers off the AsyncTCP task
+class AsyncWebWorkerPool
+{
+  private:
+    QueueHandle_t _queue;
+    SemaphoreHandle_t _stopped;
+    uint8_t _count;
+
+    static void _run(void * pool);
+
+  public:
+    AsyncWebWorkerPool();
+    ~AsyncWebWorkerPool();
+
+    bool begin(uint8_t count = AWS_WORKER_COUNT, uint32_t stackSize = AWS_WORKER_STACK_SIZE,
+               UBaseType_t priority = AWS_WORKER_PRIORITY, BaseType_t core = AWS_WORKER_CORE,
+               uint8_t queueLength = AWS_WORKER_QUEUE_LENGTH);
+
+    // Lets the workers finish the queued requests, then stops them
+    void end();
+
+    // Never blocks. Returns false if the pool is stopped or its queue is full
+    bool submit(AsyncWebServerRequest * request);
+
+    /////////////////////////////////////////////////
+
+    inline bool started() const
+    {
+      return _count != 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint8_t count() const
+    {
+      return _count;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Deferred requests not yet picked up by a worker
+    inline uint32_t pending() const
+    {
+      return _queue ? uxQueueMessagesWaiting(_queue) : 0;
+    }
+};
+
+/////////////////////////////////////////////////
+
+#endif    // ASYNCWEBWORKERPOOL_H_
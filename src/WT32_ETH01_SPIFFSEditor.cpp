@@ -537,7 +537,7 @@ bool SPIFFSEditor::canHandle(AsyncWebServerRequest *request)
         }
       }
 
-      request->addInterestingHeader("If-Modified-Since");
+      request->addInterestingHeader(AWS_HDR_IF_MODIFIED_SINCE);
       return true;
     }
 
@@ -605,7 +605,7 @@ void SPIFFSEditor::handleRequest(AsyncWebServerRequest *request)
     {
       const char * buildTime = __DATE__ " " __TIME__ " GMT";
 
-      if (request->header("If-Modified-Since").equals(buildTime))
+      if (request->header(AWS_HDR_IF_MODIFIED_SINCE).equals(buildTime))
       {
         request->send(304);
       }
@@ -630,10 +630,22 @@ void SPIFFSEditor::handleRequest(AsyncWebServerRequest *request)
   }
   else if (request->method() == HTTP_POST)
   {
-    if (request->hasParam("data", true, true) && _fs.exists(request->getParam("data", true, true)->value()))
-      request->send(200, "", "UPLOADED: " + request->getParam("data", true, true)->value());
-    else
-      request->send(500);
+    AsyncWebUploadSink * sink = request->_tempSink;
+
+    // The last sectors may still be on their way to flash : a worker waits for them, not the AsyncTCP task
+    if (sink && !sink->closed())
+    {
+      bool deferred = request->defer([this](AsyncWebServerRequest * request)
+      {
+        _uploaded(request, request->_tempSink->wait(AWS_UPLOAD_FINISH_TIMEOUT));
+      });
+
+      if (deferred)
+        return;
+    }
+
+    // A failed sink leaves a truncated file behind
+    _uploaded(request, !(sink && sink->failed()));
   }
   else if (request->method() == HTTP_PUT)
   {
@@ -668,6 +680,16 @@ void SPIFFSEditor::handleRequest(AsyncWebServerRequest *request)
 
 /////////////////////////////////////////////////
 
+void SPIFFSEditor::_uploaded(AsyncWebServerRequest *request, bool ok)
+{
+  if (ok && request->hasParam("data", true, true) && _fs.exists(request->getParam("data", true, true)->value()))
+    request->send(200, "", "UPLOADED: " + request->getParam("data", true, true)->value());
+  else
+    request->send(500);
+}
+
+/////////////////////////////////////////////////
+
 void SPIFFSEditor::handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data,
                                 size_t len, bool final)
 {
@@ -678,14 +700,46 @@ void SPIFFSEditor::handleUpload(AsyncWebServerRequest *request, const String& fi
       _authenticated = true;
       request->_tempFile = _fs.open(filename, "w");
       _startTime = millis();
+
+      // Sector-sized writes from a background task. Without memory for it, write directly
+      if (request->_tempFile)
+      {
+        request->_tempSink = new AsyncWebUploadSink(request->_tempFile);
+
+        if (!request->_tempSink->ok())
+        {
+          request->_tempSink->release();
+          request->_tempSink = NULL;
+          request->_tempFile = _fs.open(filename, "w");
+        }
+      }
     }
   }
 
-  if (_authenticated && request->_tempFile)
+  if (_authenticated && request->_tempSink)
   {
+    // Once failed, the sink drops the rest and handleRequest() answers 500
     if (len)
     {
-      request->_tempFile.write(data, len);
+      request->_tempSink->write(request, data, len);
+    }
+
+    if (final && !request->_tempSink->close())
+    {
+      AWS_LOGERROR1(F("[SPIFFSEditor] Upload not completed:"), filename);
+    }
+  }
+  else if (_authenticated && request->_tempFile)
+  {
+    if (len && (request->_tempFile.write(data, len) != len))
+    {
+      // No file makes handleRequest() answer 500
+      AWS_LOGERROR1(F("[SPIFFSEditor] Short write:"), filename);
+
+      request->_tempFile.close();
+      _fs.remove(filename);
+
+      return;
     }
 
     if (final)
@@ -54,6 +54,15 @@ class SPIFFSEditor: public AsyncWebHandler
     bool _authenticated;
     uint32_t _startTime;
 
+    void _uploaded(AsyncWebServerRequest *request, bool ok);
+
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return "/edit";
+    }
+
   public:
     SPIFFSEditor(const fs::FS& fs, const String& username = String(), const String& password = String());
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
@@ -38,156 +38,366 @@
   1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
  *****************************************************************************************************************************/
 
+#include "AsyncWebServer_WT32_ETH01.h"
 #include "WebAuthentication.h"
-#include <libb64/cencode.h>
 
-#include "mbedtls/md5.h"
-#include "mbedtls/version.h"
+#include "AsyncWebBase64.h"
+#include "AsyncWebHash.h"
+
+#if defined(ESP32) && !defined(AWS_HOST_BUILD)
+  #include "bootloader_random.h"
+
+  #define AWS_RANDOM_ENTROPY      1
+#endif
 
 /////////////////////////////////////////////////
 
 // Basic Auth hash = base64("username:password")
+// The hash is decoded a chunk at a time into a stack buffer and compared with username, ':' and password in turn,
+// so nothing is concatenated or allocated
 
 bool checkBasicAuthentication(const char * hash, const char * username, const char * password)
 {
   if (username == NULL || password == NULL || hash == NULL)
     return false;
 
-  size_t toencodeLen = strlen(username) + strlen(password) + 1;
-  size_t encodedLen = base64_encode_expected_len(toencodeLen);
+  const char * parts[3] = { username, ":", password };
+  size_t partLen[3] = { strlen(username), 1, strlen(password) };
+  size_t expectedLen = partLen[0] + 1 + partLen[2];
+  size_t hashLen = strlen(hash);
 
-  if (strlen(hash) != encodedLen)
+  if (hashLen != AWS_BASE64_ENCODED_LEN(expectedLen) || awsBase64DecodedLen(hash, hashLen) != expectedLen)
     return false;
 
-  char *toencode = new char[toencodeLen + 1];
+  uint8_t decoded[48];
+  uint8_t part = 0;
+  size_t offset = 0;
+  size_t total = 0;
+  uint8_t diff = 0;
 
-  if (toencode == NULL)
+  for (size_t i = 0; i < hashLen; i += 64)
   {
-    return false;
-  }
+    bool last = ((hashLen - i) <= 64);
+    size_t n = awsBase64Decode(hash + i, last ? (hashLen - i) : 64, decoded);
 
-  char *encoded = new char[base64_encode_expected_len(toencodeLen) + 1];
+    // Padding is only allowed at the very end : a chunk before it decoding short would skip part of the password
+    if (n == AWS_BASE64_INVALID || (!last && n != sizeof(decoded)) || (total + n > expectedLen))
+      return false;
 
-  if (encoded == NULL)
-  {
-    delete[] toencode;
+    total += n;
 
-    return false;
+    for (size_t j = 0; j < n; j++)
+    {
+      while (offset == partLen[part])
+      {
+        part++;
+        offset = 0;
+      }
+
+      diff |= decoded[j] ^ (uint8_t) parts[part][offset++];
+    }
   }
 
-  sprintf(toencode, "%s:%s", username, password);
+  return (diff == 0 && total == expectedLen);
+}
 
-  if (base64_encode_chars(toencode, toencodeLen, encoded) > 0 && memcmp(hash, encoded, encodedLen) == 0)
-  {
-    delete[] toencode;
-    delete[] encoded;
+/////////////////////////////////////////////////
+
+static bool getMD5(uint8_t * data, uint16_t len, char * output)
+{
+  //33 bytes or more
+  AsyncWebHash md5(AWS_HASH_MD5);
+
+  md5.update(data, len);
+  md5.finishHex(output);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+static String genRandomMD5()
+{
+  uint32_t r = rand();
+  char out[33];
 
-    return true;
+  getMD5((uint8_t*)(&r), 4, out);
+
+  return String(out);
+}
+
+/////////////////////////////////////////////////
+
+String generateDigestHash(const char * username, const char * password, const char * realm)
+{
+  if (username == NULL || password == NULL || realm == NULL)
+  {
+    return "";
   }
 
-  delete[] toencode;
-  delete[] encoded;
+  char * out = (char*)malloc(33);
+  String res = String(username);
+  res.concat(":");
+  res.concat(realm);
+  res.concat(":");
+  String in = res;
+  in.concat(password);
+
+  if (out == NULL || !getMD5((uint8_t*)(in.c_str()), in.length(), out))
+    return "";
 
-  return false;
+  res.concat(out);
+  free(out);
+
+  return res;
 }
 
 /////////////////////////////////////////////////
 
-static bool getMD5(uint8_t * data, uint16_t len, char * output)
+// bootloader_random_enable() / _disable() don't nest
+static AsyncWebLock randomLock;
+
+// esp_random() only draws on hardware noise while the radio runs, otherwise it is pseudo-random. On a
+// wired-only board, the SAR ADC entropy source is switched on for the duration of the read instead
+void awsRandomFill(void * buf, size_t len)
 {
-  //33 bytes or more
-  mbedtls_md5_context _ctx;
-  uint8_t i;
-  uint8_t * _buf = (uint8_t*)malloc(16);
+  uint8_t * p = (uint8_t *) buf;
 
-  if (_buf == NULL)
-    return false;
+  AsyncWebLockGuard l(randomLock);
 
-  memset(_buf, 0x00, 16);
+#if AWS_RANDOM_ENTROPY
+  bool rfOff = (WiFi.getMode() == WIFI_OFF);
 
-  mbedtls_md5_init(&_ctx);
+  if (rfOff)
+    bootloader_random_enable();
+#endif
 
-#if (MBEDTLS_VERSION_NUMBER < 0x02070000)
-  // Superseded from v2.7.0
-  mbedtls_md5_starts(&_ctx);
-  mbedtls_md5_update(&_ctx, data, len);
-  mbedtls_md5_finish(&_ctx, _buf);
-#else
-  mbedtls_md5_starts_ret(&_ctx);
-  mbedtls_md5_update_ret(&_ctx, data, len);
-  mbedtls_md5_finish_ret(&_ctx, _buf);
+  while (len)
+  {
+    uint32_t r = esp_random();
+    size_t n = (len < sizeof(r)) ? len : sizeof(r);
+
+    memcpy(p, &r, n);
+
+    p += n;
+    len -= n;
+  }
+
+#if AWS_RANDOM_ENTROPY
+  if (rfOff)
+    bootloader_random_disable();
 #endif
+}
+
+/////////////////////////////////////////////////
+
+static AsyncWebLock digestLock;
+
+#if (AWS_DIGEST_NONCE_COUNT > 0)
+
+typedef struct
+{
+  char nonce[33];
+  uint32_t issued;
+  uint32_t maxNc;     // highest nonce count seen
+  uint32_t seen;      // bit i : nonce count (maxNc - i) was used
+} AwsDigestNonce;
+
+static AwsDigestNonce digestNonces[AWS_DIGEST_NONCE_COUNT];
+
+/////////////////////////////////////////////////
+
+// Random 128-bit nonce, stored in the free or the oldest slot
+static String newDigestNonce()
+{
+  static const char hex[] = "0123456789abcdef";
+
+  AsyncWebLockGuard l(digestLock);
+
+  AwsDigestNonce * slot = &digestNonces[0];
+
+  for (size_t i = 0; i < AWS_DIGEST_NONCE_COUNT; i++)
+  {
+    if (!digestNonces[i].nonce[0])
+    {
+      slot = &digestNonces[i];
+      break;
+    }
+
+    if ((int32_t) (digestNonces[i].issued - slot->issued) < 0)
+      slot = &digestNonces[i];
+  }
 
-  for (i = 0; i < 16; i++)
+  uint8_t r[16];
+
+  // Seeded entropy, not bare esp_random(), which is pseudo-random while the radio is off
+  awsRandomFill(r, sizeof(r));
+
+  for (uint8_t i = 0; i < sizeof(r); i++)
   {
-    sprintf(output + (i * 2), "%02x", _buf[i]);
+    slot->nonce[i * 2] = hex[r[i] >> 4];
+    slot->nonce[i * 2 + 1] = hex[r[i] & 0x0F];
   }
 
-  free(_buf);
+  slot->nonce[32] = 0;
+  slot->issued = millis();
+  slot->maxNc = 0;
+  slot->seen = 0;
 
-  return true;
+  return String(slot->nonce);
 }
 
 /////////////////////////////////////////////////
 
-static String genRandomMD5()
+typedef enum { DIGEST_NONCE_OK, DIGEST_NONCE_STALE, DIGEST_NONCE_REPLAY } AwsDigestNonceCheck;
+
+// Consumes nonce count nc of a known nonce. Counts may arrive out of order over parallel connections,
+// so the last 32 below the highest one are tracked
+static AwsDigestNonceCheck useDigestNonce(const char * nonce, size_t len, const char * nc, size_t ncLen, bool hasQop)
 {
-  uint32_t r = rand();
-  char * out = (char*)malloc(33);
+  AsyncWebLockGuard l(digestLock);
 
-  if (out == NULL || !getMD5((uint8_t*)(&r), 4, out))
-    return "";
+  for (size_t i = 0; i < AWS_DIGEST_NONCE_COUNT; i++)
+  {
+    AwsDigestNonce * e = &digestNonces[i];
 
-  String res = String(out);
-  free(out);
+    if (len != 32 || memcmp(e->nonce, nonce, 32))
+      continue;
 
-  return res;
+    if ((millis() - e->issued) > AWS_DIGEST_NONCE_LIFETIME)
+    {
+      e->nonce[0] = 0;
+
+      return DIGEST_NONCE_STALE;
+    }
+
+    // Without qop (RFC 2069) there is no nonce count
+    if (!hasQop)
+      return DIGEST_NONCE_OK;
+
+    char buf[9];
+
+    if (!ncLen || ncLen > 8)
+      return DIGEST_NONCE_REPLAY;
+
+    memcpy(buf, nc, ncLen);
+    buf[ncLen] = 0;
+
+    uint32_t n = strtoul(buf, NULL, 16);
+
+    if (n == 0)
+      return DIGEST_NONCE_REPLAY;
+
+    if (n > e->maxNc)
+    {
+      uint32_t shift = n - e->maxNc;
+
+      e->seen = (shift >= 32) ? 1 : ((e->seen << shift) | 1);
+      e->maxNc = n;
+
+      return DIGEST_NONCE_OK;
+    }
+
+    uint32_t age = e->maxNc - n;
+
+    if (age >= 32 || (e->seen & (1UL << age)))
+      return DIGEST_NONCE_REPLAY;
+
+    e->seen |= (1UL << age);
+
+    return DIGEST_NONCE_OK;
+  }
+
+  return DIGEST_NONCE_STALE;
 }
 
+#endif
+
 /////////////////////////////////////////////////
 
-static String stringMD5(const String& in)
+#if (AWS_DIGEST_HA1_CACHE > 0)
+
+typedef struct
 {
-  char * out = (char*)malloc(33);
+  uint64_t key;       // FNV-1a of username, realm and password, 0 if unused
+  char ha1[33];
+} AwsDigestHa1;
 
-  if (out == NULL || !getMD5((uint8_t*)(in.c_str()), in.length(), out))
-    return "";
+static AwsDigestHa1 digestHa1[AWS_DIGEST_HA1_CACHE];
+static uint8_t digestHa1Next;
 
-  String res = String(out);
-  free(out);
+#endif
 
-  return res;
+/////////////////////////////////////////////////
+
+static uint64_t digestKey(const char * username, size_t userLen, const char * realm, size_t realmLen, const char * password)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (size_t i = 0; i < userLen; i++)
+    hash = (hash ^ (uint8_t) username[i]) * 1099511628211ULL;
+
+  hash = (hash ^ 0xFF) * 1099511628211ULL;
+
+  for (size_t i = 0; i < realmLen; i++)
+    hash = (hash ^ (uint8_t) realm[i]) * 1099511628211ULL;
+
+  hash = (hash ^ 0xFF) * 1099511628211ULL;
+
+  for (; *password; password++)
+    hash = (hash ^ (uint8_t) *password) * 1099511628211ULL;
+
+  return hash | 1;
 }
 
 /////////////////////////////////////////////////
 
-String generateDigestHash(const char * username, const char * password, const char * realm)
+// ha1 : 33 bytes or more
+static void digestHA1(const char * username, size_t userLen, const char * realm, size_t realmLen, const char * password,
+                      char * ha1)
 {
-  if (username == NULL || password == NULL || realm == NULL)
+#if (AWS_DIGEST_HA1_CACHE > 0)
+  uint64_t key = digestKey(username, userLen, realm, realmLen, password);
+
   {
-    return "";
+    AsyncWebLockGuard l(digestLock);
+
+    for (size_t i = 0; i < AWS_DIGEST_HA1_CACHE; i++)
+    {
+      if (digestHa1[i].key == key)
+      {
+        memcpy(ha1, digestHa1[i].ha1, 33);
+
+        return;
+      }
+    }
   }
+#endif
 
-  char * out = (char*)malloc(33);
-  String res = String(username);
-  res.concat(":");
-  res.concat(realm);
-  res.concat(":");
-  String in = res;
-  in.concat(password);
+  AsyncWebHash md5(AWS_HASH_MD5);
 
-  if (out == NULL || !getMD5((uint8_t*)(in.c_str()), in.length(), out))
-    return "";
+  md5.update(username, userLen);
+  md5.update(":", 1);
+  md5.update(realm, realmLen);
+  md5.update(":", 1);
+  md5.update(password, strlen(password));
+  md5.finishHex(ha1);
 
-  res.concat(out);
-  free(out);
+#if (AWS_DIGEST_HA1_CACHE > 0)
+  AsyncWebLockGuard l(digestLock);
 
-  return res;
+  AwsDigestHa1 * e = &digestHa1[digestHa1Next];
+
+  digestHa1Next = (digestHa1Next + 1) % AWS_DIGEST_HA1_CACHE;
+
+  e->key = key;
+  memcpy(e->ha1, ha1, 33);
+#endif
 }
 
 /////////////////////////////////////////////////
 
-String requestDigestAuthentication(const char * realm)
+String requestDigestAuthentication(const char * realm, bool stale)
 {
   String header = "realm=\"";
 
@@ -197,20 +407,144 @@ String requestDigestAuthentication(const char * realm)
     header.concat(realm);
 
   header.concat( "\", qop=\"auth\", nonce=\"");
+
+#if (AWS_DIGEST_NONCE_COUNT > 0)
+  header.concat(newDigestNonce());
+#else
   header.concat(genRandomMD5());
+#endif
+
   header.concat("\", opaque=\"");
   header.concat(genRandomMD5());
   header.concat("\"");
 
+  if (stale)
+    header.concat(", stale=TRUE");
+
   return header;
 }
 
 /////////////////////////////////////////////////
 
+typedef enum
+{
+  DIGEST_USERNAME,
+  DIGEST_REALM,
+  DIGEST_NONCE,
+  DIGEST_URI,
+  DIGEST_RESPONSE,
+  DIGEST_QOP,
+  DIGEST_NC,
+  DIGEST_CNONCE,
+  DIGEST_OPAQUE,
+  DIGEST_FIELDS
+} AwsDigestFieldId;
+
+static const char * const digestFieldNames[DIGEST_FIELDS] =
+{
+  "username", "realm", "nonce", "uri", "response", "qop", "nc", "cnonce", "opaque"
+};
+
+typedef struct
+{
+  const char * value;
+  size_t len;
+} AwsDigestField;
+
+/////////////////////////////////////////////////
+
+// Splits 'name=value, name="value", ...' in place : fields point into header
+static bool parseDigestHeader(const char * p, AwsDigestField * fields)
+{
+  memset(fields, 0, DIGEST_FIELDS * sizeof(AwsDigestField));
+
+  while (*p)
+  {
+    while (*p == ' ' || *p == '\t' || *p == ',')
+      p++;
+
+    if (!*p)
+      break;
+
+    const char * name = p;
+
+    while (*p && *p != '=' && *p != ',')
+      p++;
+
+    if (*p != '=')
+    {
+      AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, no = sign"));
+
+      return false;
+    }
+
+    size_t nameLen = p - name;
+
+    while (nameLen && name[nameLen - 1] == ' ')
+      nameLen--;
+
+    p++;
+
+    while (*p == ' ')
+      p++;
+
+    const char * value = p;
+    size_t len;
+
+    if (*p == '"')
+    {
+      value = ++p;
+
+      // Quoted values may hold commas (uri)
+      while (*p && *p != '"')
+        p++;
+
+      len = p - value;
+
+      if (*p)
+        p++;
+    }
+    else
+    {
+      while (*p && *p != ',')
+        p++;
+
+      len = p - value;
+
+      while (len && value[len - 1] == ' ')
+        len--;
+    }
+
+    for (uint8_t i = 0; i < DIGEST_FIELDS; i++)
+    {
+      if (strlen(digestFieldNames[i]) == nameLen && !strncmp(name, digestFieldNames[i], nameLen))
+      {
+        fields[i].value = value;
+        fields[i].len = len;
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+static inline bool digestFieldIs(const AwsDigestField& field, const char * expected)
+{
+  return field.value && (strlen(expected) == field.len) && !memcmp(field.value, expected, field.len);
+}
+
+/////////////////////////////////////////////////
+
 bool checkDigestAuthentication(const char * header, const char * method, const char * username, const char * password,
                                const char * realm,
-                               bool passwordIsHash, const char * nonce, const char * opaque, const char * uri)
+                               bool passwordIsHash, const char * nonce, const char * opaque, const char * uri, bool * stale)
 {
+  if (stale)
+    *stale = false;
+
   if (username == NULL || password == NULL || header == NULL || method == NULL)
   {
     AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, missing required fields"));
@@ -218,150 +552,127 @@ bool checkDigestAuthentication(const char * header, const char * method, const c
     return false;
   }
 
-  String myHeader = String(header);
-  int nextBreak = myHeader.indexOf(",");
+  AwsDigestField f[DIGEST_FIELDS];
 
-  if (nextBreak < 0)
+  if (!parseDigestHeader(header, f))
+    return false;
+
+  if (!f[DIGEST_USERNAME].value || !f[DIGEST_NONCE].value || !f[DIGEST_RESPONSE].value || f[DIGEST_RESPONSE].len != 32)
   {
     AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, no variables"));
 
     return false;
   }
 
-  String myUsername = String();
-  String myRealm = String();
-  String myNonce = String();
-  String myUri = String();
-  String myResponse = String();
-  String myQop = String();
-  String myNc = String();
-  String myCnonce = String();
+  if (!digestFieldIs(f[DIGEST_USERNAME], username))
+  {
+    AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, username"));
 
-  myHeader += ", ";
+    return false;
+  }
 
-  do
+  if (realm != NULL && !digestFieldIs(f[DIGEST_REALM], realm))
   {
-    String avLine = myHeader.substring(0, nextBreak);
-    avLine.trim();
-    myHeader = myHeader.substring(nextBreak + 1);
-    nextBreak = myHeader.indexOf(",");
+    AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, realm"));
 
-    int eqSign = avLine.indexOf("=");
+    return false;
+  }
 
-    if (eqSign < 0)
-    {
-      AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, no = sign"));
+  if (nonce != NULL && !digestFieldIs(f[DIGEST_NONCE], nonce))
+  {
+    AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, nonce"));
 
-      return false;
-    }
+    return false;
+  }
 
-    String varName = avLine.substring(0, eqSign);
-    avLine = avLine.substring(eqSign + 1);
+  if (opaque != NULL && !digestFieldIs(f[DIGEST_OPAQUE], opaque))
+  {
+    AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, opaque"));
 
-    if (avLine.startsWith("\""))
-    {
-      avLine = avLine.substring(1, avLine.length() - 1);
-    }
+    return false;
+  }
 
-    if (varName.equals("username"))
-    {
-      if (!avLine.equals(username))
-      {
-        AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, username"));
+  if (uri != NULL && !digestFieldIs(f[DIGEST_URI], uri))
+  {
+    AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, uri"));
 
-        return false;
-      }
+    return false;
+  }
 
-      AWS_LOGINFO1(F("checkDigestAuthentication: myUsername ="), myUsername);
+  char ha1[33];
+  char ha2[33];
+  char expected[33];
+  AsyncWebHash md5(AWS_HASH_MD5);
 
-      myUsername = avLine;
-    }
-    else if (varName.equals("realm"))
-    {
-      if (realm != NULL && !avLine.equals(realm))
-      {
-        AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, realm"));
+  if (passwordIsHash)
+  {
+    strncpy(ha1, password, 32);
+    ha1[32] = 0;
+  }
+  else
+  {
+    digestHA1(f[DIGEST_USERNAME].value, f[DIGEST_USERNAME].len, f[DIGEST_REALM].value, f[DIGEST_REALM].len, password, ha1);
+  }
 
-        return false;
-      }
+  md5.update(method, strlen(method));
+  md5.update(":", 1);
+  md5.update(f[DIGEST_URI].value, f[DIGEST_URI].len);
+  md5.finishHex(ha2);
 
-      AWS_LOGINFO1(F("checkDigestAuthentication: myRealm ="), myRealm);
+  bool hasQop = (f[DIGEST_QOP].value != NULL);
 
-      myRealm = avLine;
-    }
-    else if (varName.equals("nonce"))
-    {
-      if (nonce != NULL && !avLine.equals(nonce))
-      {
-        AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, nonce"));
+  md5.update(ha1, strlen(ha1));
+  md5.update(":", 1);
+  md5.update(f[DIGEST_NONCE].value, f[DIGEST_NONCE].len);
+  md5.update(":", 1);
 
-        return false;
-      }
+  if (hasQop)
+  {
+    md5.update(f[DIGEST_NC].value, f[DIGEST_NC].len);
+    md5.update(":", 1);
+    md5.update(f[DIGEST_CNONCE].value, f[DIGEST_CNONCE].len);
+    md5.update(":", 1);
+    md5.update(f[DIGEST_QOP].value, f[DIGEST_QOP].len);
+    md5.update(":", 1);
+  }
 
-      AWS_LOGINFO1(F("checkDigestAuthentication: myNonce ="), myNonce);
+  md5.update(ha2, 32);
+  md5.finishHex(expected);
 
-      myNonce = avLine;
-    }
-    else if (varName.equals("opaque"))
-    {
-      if (opaque != NULL && !avLine.equals(opaque))
-      {
-        AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, opaque"));
+  uint8_t diff = 0;
 
-        return false;
-      }
-    }
-    else if (varName.equals("uri"))
-    {
-      if (uri != NULL && !avLine.equals(uri))
-      {
-        AWS_LOGERROR(F("checkDigestAuthentication: AUTH FAIL, uri"));
+  for (uint8_t i = 0; i < 32; i++)
+    diff |= (uint8_t) (expected[i] ^ tolower(f[DIGEST_RESPONSE].value[i]));
 
-        return false;
-      }
+  if (diff)
+  {
+    AWS_LOGINFO(F("AUTH FAIL: password"));
 
-      AWS_LOGINFO1(F("checkDigestAuthentication: myUri ="), myUri);
+    return false;
+  }
 
-      myUri = avLine;
-    }
-    else if (varName.equals("response"))
-    {
-      AWS_LOGINFO1(F("checkDigestAuthentication: myResponse ="), myResponse);
+#if (AWS_DIGEST_NONCE_COUNT > 0)
 
-      myResponse = avLine;
-    }
-    else if (varName.equals("qop"))
-    {
-      AWS_LOGINFO1(F("checkDigestAuthentication: myQop ="), myQop);
+  // Only a correct response consumes a nonce count
+  if (nonce == NULL)
+  {
+    AwsDigestNonceCheck check = useDigestNonce(f[DIGEST_NONCE].value, f[DIGEST_NONCE].len, f[DIGEST_NC].value,
+                                               f[DIGEST_NC].len, hasQop);
 
-      myQop = avLine;
-    }
-    else if (varName.equals("nc"))
+    if (check != DIGEST_NONCE_OK)
     {
-      AWS_LOGINFO1(F("checkDigestAuthentication: myNc ="), myNc);
+      if (stale && check == DIGEST_NONCE_STALE)
+        *stale = true;
 
-      myNc = avLine;
-    }
-    else if (varName.equals("cnonce"))
-    {
-      AWS_LOGINFO1(F("checkDigestAuthentication: myCnonce ="), myCnonce);
+      AWS_LOGINFO(check == DIGEST_NONCE_STALE ? F("AUTH FAIL: stale nonce") : F("AUTH FAIL: nonce count replayed"));
 
-      myCnonce = avLine;
+      return false;
     }
-  } while (nextBreak > 0);
-
-  String ha1 = (passwordIsHash) ? String(password) : stringMD5(myUsername + ":" + myRealm + ":" + String(password));
-  String ha2 = String(method) + ":" + myUri;
-  String response = ha1 + ":" + myNonce + ":" + myNc + ":" + myCnonce + ":" + myQop + ":" + stringMD5(ha2);
-
-  if (myResponse.equals(stringMD5(response)))
-  {
-    AWS_LOGINFO(F("AUTH SUCCESS"));
-
-    return true;
   }
 
-  AWS_LOGINFO(F("AUTH FAIL: password"));
+#endif
+
+  AWS_LOGINFO(F("AUTH SUCCESS"));
 
-  return false;
+  return true;
 }
@@ -47,16 +47,41 @@
 
 /////////////////////////////////////////////////
 
+// Digest nonces handed out by requestDigestAuthentication() and checked by checkDigestAuthentication().
+// A browser reuses a nonce with an increasing nonce count, so it only gets a new 401 once the nonce expires
+// or is evicted. Set AWS_DIGEST_NONCE_COUNT to 0 to accept any nonce, as before
+#ifndef AWS_DIGEST_NONCE_COUNT
+  #define AWS_DIGEST_NONCE_COUNT        8
+#endif
+
+#ifndef AWS_DIGEST_NONCE_LIFETIME
+  #define AWS_DIGEST_NONCE_LIFETIME     300000UL    // ms
+#endif
+
+// HA1 = MD5(username:realm:password) kept for the last few username / realm / password triples
+#ifndef AWS_DIGEST_HA1_CACHE
+  #define AWS_DIGEST_HA1_CACHE          4
+#endif
+
+/////////////////////////////////////////////////
+
 bool checkBasicAuthentication(const char * header, const char * username, const char * password);
-String requestDigestAuthentication(const char * realm);
+String requestDigestAuthentication(const char * realm, bool stale = false);
 
+// With nonce == NULL the header's nonce must be one handed out by requestDigestAuthentication(), and its nonce count
+// one not seen before. *stale is set when only the nonce was rejected, the browser then retries without prompting
 bool checkDigestAuthentication(const char * header, const char * method, const char * username, const char * password,
                                const char * realm,
-                               bool passwordIsHash, const char * nonce, const char * opaque, const char * uri);
+                               bool passwordIsHash, const char * nonce, const char * opaque, const char * uri,
+                               bool * stale = NULL);
 
 //for storing hashed versions on the device that can be authenticated against
 String generateDigestHash(const char * username, const char * password, const char * realm);
 
+// Random bytes for keys and nonces, from the hardware RNG with an entropy source running.
+// Call it once the system is up (not from static constructors); with WiFi off it briefly uses the SAR ADC
+void awsRandomFill(void * buf, size_t len);
+
 /////////////////////////////////////////////////
 
 #endif    // WEB_AUTHENTICATION_H_
@@ -76,6 +76,13 @@ class AsyncStaticWebHandler: public AsyncWebHandler
     bool _gzipFirst;
     uint8_t _gzipStats;
 
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return _uri;
+    }
+
   public:
     AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cache_control);
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
@@ -107,6 +114,13 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
     ArBodyHandlerFunction _onBody;
     bool _isRegex;
 
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return _uri;
+    }
+
   public:
     AsyncCallbackWebHandler() : _uri(), _method(HTTP_ANY), _onRequest(NULL), _onUpload(NULL), _onBody(NULL),
       _isRegex(false) {}
@@ -199,7 +213,7 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
         else if (_uri.length() && (_uri != request->url() && !request->url().startsWith(_uri + "/")))
           return false;
 
-      request->addInterestingHeader("ANY");
+      request->addInterestingHeader(AWS_HDR_ANY);
 
       return true;
     }
@@ -208,8 +222,8 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
 
     virtual void handleRequest(AsyncWebServerRequest *request) override final
     {
-      if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
-        return request->requestAuthentication();
+      if (!_authorized(request))
+        return _requestAuthorization(request);
 
       if (_onRequest)
         _onRequest(request);
@@ -222,8 +236,8 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
     virtual void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data,
                               size_t len, bool final) override final
     {
-      if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
-        return request->requestAuthentication();
+      if (!_authorized(request))
+        return _requestAuthorization(request);
 
       if (_onUpload)
         _onUpload(request, filename, index, data, len, final);
@@ -234,8 +248,8 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
     virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index,
                             size_t total) override final
     {
-      if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
-        return request->requestAuthentication();
+      if (!_authorized(request))
+        return _requestAuthorization(request);
 
       if (_onBody)
         _onBody(request, data, len, index, total);
@@ -249,4 +263,37 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
     }
 };
 
+/////////////////////////////////////////////////
+
+#if AWS_METRICS
+
+// GET uri answers the metrics of every handler of server, and of its onNotFound() one, in the Prometheus
+// text format. Mount it like any handler, server.addHandler(&metrics), and protect it with setAuthentication()
+// or setTokenAuthentication() if needed. The output is generated one metric and handler at a time while sending
+class AsyncWebMetricsHandler: public AsyncWebHandler
+{
+  protected:
+    AsyncWebServer * _server;
+    String _uri;
+
+    /////////////////////////////////////////////////
+
+    virtual String _metricsRoute() const override
+    {
+      return _uri;
+    }
+
+  public:
+    AsyncWebMetricsHandler(AsyncWebServer * server, const String& uri = "/metrics") : _server(server), _uri(uri) {}
+
+    virtual bool canHandle(AsyncWebServerRequest *request) override final;
+    virtual void handleRequest(AsyncWebServerRequest *request) override final;
+
+    // Appends metric family of the n-th handler to out, with the family's HELP and TYPE lines before handler 0.
+    // Returns false once n is past the last handler
+    bool _render(uint8_t family, size_t n, String& out) const;
+};
+
+#endif
+
 #endif /* ASYNCWEBSERVERHANDLERIMPL_H_ */
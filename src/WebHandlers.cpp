@@ -44,6 +44,34 @@
 
 /////////////////////////////////////////////////
 
+bool AsyncWebHandler::_authorized(AsyncWebServerRequest *request)
+{
+  bool hasCredentials = (_username != "" && _password != "");
+
+  if (_tokenAuth && request->authenticate(*_tokenAuth))
+    return true;
+
+  if (hasCredentials)
+    return request->authenticate(_username.c_str(), _password.c_str());
+
+  return (_tokenAuth == NULL);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebHandler::_requestAuthorization(AsyncWebServerRequest *request)
+{
+  if (_username != "" && _password != "")
+    return request->requestAuthentication();
+
+  AsyncWebServerResponse * r = request->beginResponse(401);
+
+  r->addHeader("WWW-Authenticate", "Bearer");
+  request->send(r);
+}
+
+/////////////////////////////////////////////////
+
 AsyncStaticWebHandler::AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cache_control)
   : _fs(fs), _uri(uri), _path(path), _default_file("index.htm"), _cache_control(cache_control), _last_modified(""),
     _callback(nullptr)
@@ -132,10 +160,10 @@ bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest *request)
   {
     // We interested in "If-Modified-Since" header to check if file was modified
     if (_last_modified.length())
-      request->addInterestingHeader("If-Modified-Since");
+      request->addInterestingHeader(AWS_HDR_IF_MODIFIED_SINCE);
 
     if (_cache_control.length())
-      request->addInterestingHeader("If-None-Match");
+      request->addInterestingHeader(AWS_HDR_IF_NONE_MATCH);
 
     AWS_LOGDEBUG("[AsyncStaticWebHandler::canHandle] TRUE");
 
@@ -256,20 +284,20 @@ void AsyncStaticWebHandler::handleRequest(AsyncWebServerRequest *request)
   free(request->_tempObject);
   request->_tempObject = NULL;
 
-  if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
-    return request->requestAuthentication();
+  if (!_authorized(request))
+    return _requestAuthorization(request);
 
   if (request->_tempFile == true)
   {
     String etag = String(request->_tempFile.size());
 
-    if (_last_modified.length() && _last_modified == request->header("If-Modified-Since"))
+    if (_last_modified.length() && _last_modified == request->header(AWS_HDR_IF_MODIFIED_SINCE))
     {
       request->_tempFile.close();
       request->send(304); // Not modified
     }
-    else if (_cache_control.length() && request->hasHeader("If-None-Match")
-             && request->header("If-None-Match").equals(etag))
+    else if (_cache_control.length() && request->hasHeader(AWS_HDR_IF_NONE_MATCH)
+             && request->header(AWS_HDR_IF_NONE_MATCH).equals(etag))
     {
       request->_tempFile.close();
       AsyncWebServerResponse * response = new AsyncBasicResponse(304); // Not modified
@@ -58,11 +58,88 @@ enum { PARSE_REQ_START, PARSE_REQ_HEADERS, PARSE_REQ_BODY, PARSE_REQ_END, PARSE_
 
 /////////////////////////////////////////////////
 
+// Value of a hex digit, -1 for any other byte
+static const int8_t hexValue[256] =
+{
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/////////////////////////////////////////////////
+
+// Decodes %XX escapes and '+' in place and returns the decoded length. Malformed escapes are kept as is
+static size_t urlDecodeInPlace(char * buf, size_t len)
+{
+  char * in = buf;
+  char * end = buf + len;
+
+  // Most names and values have nothing to decode
+  while (in < end && *in != '%' && *in != '+')
+    in++;
+
+  char * out = in;
+
+  while (in < end)
+  {
+    char c = *in++;
+
+    if (c == '+')
+    {
+      c = ' ';
+    }
+    else if (c == '%' && (end - in) >= 2)
+    {
+      int8_t hi = hexValue[(uint8_t) in[0]];
+      int8_t lo = hexValue[(uint8_t) in[1]];
+
+      if ((hi | lo) >= 0)
+      {
+        c = (char) ((hi << 4) | lo);
+        in += 2;
+      }
+    }
+
+    *out++ = c;
+  }
+
+  return out - buf;
+}
+
+/////////////////////////////////////////////////
+
+static inline String sliceToString(const char * data, size_t len)
+{
+  String s;
+
+  if (len)
+    s.concat(data, len);
+
+  return s;
+}
+
+/////////////////////////////////////////////////
+
 AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
   : _client(c)
   , _server(s)
   , _handler(NULL)
   , _response(NULL)
+  , _interestingMask(0)
+  , _interestingAny(false)
   , _temp()
   , _parseState(0)
   , _version(0)
@@ -72,8 +149,12 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
   , _contentType()
   , _boundary()
   , _authorization()
+  , _token()
   , _reqconntype(RCT_HTTP)
   , _isDigest(false)
+  , _authPassed(0)
+  , _authFailed(0)
+  , _authStale(false)
   , _isMultipart(false)
   , _isPlainPost(false)
   , _expectingContinue(false)
@@ -91,6 +172,14 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
 {
   delete p;
 }))
+, _rawHeaders(NULL)
+, _rawHeadersTail(&_rawHeaders)
+, _rawQuery(NULL)
+, _rawQueryTail(&_rawQuery)
+, _headersFiltered(false)
+, _presentHeaders(0)
+, _headerIndex(NULL)
+, _paramIndex(NULL)
 , _multiParseState(0)
 , _boundaryPosition(0)
 , _itemStartIndex(0)
@@ -102,7 +191,26 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
 , _itemBuffer(0)
 , _itemBufferIndex(0)
 , _itemIsFile(false)
+, _delimiter()
+, _delimiterSkip(NULL)
+, _delimiterMatched(0)
+, _timer([](void *r)
+{
+  ((AsyncWebServerRequest*)(r))->_onTimer();
+}, this)
+, _startTime(millis())
+, _lastRxTime(_startTime)
+, _deferredFn(nullptr)
+, _deferState(AWS_DEFER_NONE)
+, _deferredResponse(NULL)
+#if AWS_METRICS
+, _metricsStart(micros())
+, _metricsBytesIn(0)
+, _metricsBytesOut(0)
+, _metricsCode(0)
+#endif
 , _tempObject(NULL)
+, _tempSink(NULL)
 {
   c->onError([](void *r, AsyncClient * c, int8_t error)
   {
@@ -145,12 +253,27 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
     AsyncWebServerRequest *req = ( AsyncWebServerRequest*)r;
     req->_onPoll();
   }, this);
+
+  _armTimer();
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebServerRequest::~AsyncWebServerRequest()
 {
+#if AWS_METRICS
+
+  if (_handler)
+  {
+    AsyncWebHandlerMetrics& m = _handler->metrics();
+
+    m.countRequest(_metricsCode);
+    m.bytesIn.add(_metricsBytesIn);
+    m.bytesOut.add(_metricsBytesOut);
+  }
+
+#endif
+
   _headers.free();
 
   _params.free();
@@ -163,10 +286,30 @@ AsyncWebServerRequest::~AsyncWebServerRequest()
     delete _response;
   }
 
+  if (_deferredResponse != NULL)
+  {
+    delete _deferredResponse;
+  }
+
   if (_tempObject != NULL)
   {
     free(_tempObject);
   }
+
+  if (_tempSink != NULL)
+  {
+    _tempSink->release();
+  }
+
+  if (_itemBuffer != NULL)
+  {
+    free(_itemBuffer);
+  }
+
+  if (_delimiterSkip != NULL)
+  {
+    free(_delimiterSkip);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -175,6 +318,12 @@ void AsyncWebServerRequest::_onData(void *buf, size_t len)
 {
   size_t i = 0;
 
+  _lastRxTime = millis();
+
+#if AWS_METRICS
+  _metricsBytesIn += len;
+#endif
+
   while (true)
   {
     if (_parseState < PARSE_REQ_BODY)
@@ -226,13 +375,7 @@ void AsyncWebServerRequest::_onData(void *buf, size_t len)
       {
         if (needParse)
         {
-          size_t i;
-
-          for (i = 0; i < len; i++)
-          {
-            _parseMultipartPostByte(((uint8_t*)buf)[i], i == len - 1);
-            _parsedLength++;
-          }
+          _parseMultipart((uint8_t*)buf, len);
         }
         else
           _parsedLength += len;
@@ -268,13 +411,7 @@ void AsyncWebServerRequest::_onData(void *buf, size_t len)
         }
         else if (needParse)
         {
-          size_t i;
-
-          for (i = 0; i < len; i++)
-          {
-            _parsedLength++;
-            _parsePlainPostChar(((uint8_t*)buf)[i]);
-          }
+          _parsePlainPost((char*)buf, len);
         }
         else
         {
@@ -303,26 +440,108 @@ void AsyncWebServerRequest::_onData(void *buf, size_t len)
 
 void AsyncWebServerRequest::_removeNotInterestingHeaders()
 {
-  if (_interestingHeaders.containsIgnoreCase("ANY"))
+  if (_interestingAny)
     return; // nothing to do
 
+  // Headers still raw are filtered when they are materialized
+  _headersFiltered = true;
+
   for (const auto& header : _headers)
   {
-    if (!_interestingHeaders.containsIgnoreCase(header->name().c_str()))
+    const String& name = header->name();
+
+    if (!_isInterestingHeader(awsHeaderId(name.c_str(), name.length()), name.c_str(), name.length()))
     {
       _headers.remove(header);
     }
   }
+
+  // Rebuilt on the next lookup
+  _headerIndex = NULL;
 }
 
 /////////////////////////////////////////////////
 
 void AsyncWebServerRequest::_onPoll()
 {
+  if (_deferState.load() == AWS_DEFER_DONE)
+  {
+    _completeDeferred();
+  }
+
+  // A window withheld while flash was busy
+  if (_tempSink != NULL)
+  {
+    _tempSink->poll();
+  }
+
   if (_response != NULL && _client != NULL && _client->canSend() && !_response->_finished())
   {
     _response->_ack(this, 0, 0);
   }
+
+  // Last, expiring timers may close this request
+  _server->timers().poll();
+}
+
+/////////////////////////////////////////////////
+
+// One timer per request, re-armed lazily : receiving data only records the time
+void AsyncWebServerRequest::_armTimer()
+{
+  uint32_t now = millis();
+  uint32_t delay = 0xFFFFFFFF;
+
+  uint32_t idleTimeout = _server->requestIdleTimeout();
+  uint32_t headerTimeout = _server->requestHeaderTimeout();
+
+  if (idleTimeout)
+  {
+    uint32_t idle = now - _lastRxTime;
+
+    delay = (idle < idleTimeout) ? (idleTimeout - idle) : 0;
+  }
+
+  if (headerTimeout && _parseState < PARSE_REQ_BODY)
+  {
+    uint32_t elapsed = now - _startTime;
+    uint32_t headerDelay = (elapsed < headerTimeout) ? (headerTimeout - elapsed) : 0;
+
+    if (headerDelay < delay)
+      delay = headerDelay;
+  }
+
+  if (delay == 0xFFFFFFFF)
+    _timer.cancel();
+  else
+    _server->timers().schedule(_timer, delay);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_onTimer()
+{
+  uint32_t now = millis();
+  uint32_t idleTimeout = _server->requestIdleTimeout();
+  uint32_t headerTimeout = _server->requestHeaderTimeout();
+
+  if (idleTimeout && (now - _lastRxTime) >= idleTimeout)
+  {
+    _onTimeout(now - _lastRxTime);
+
+    return;
+  }
+
+  if (headerTimeout && _parseState < PARSE_REQ_BODY && (now - _startTime) >= headerTimeout)
+  {
+    AWS_LOGDEBUG1("Request headers deadline exceeded, state =", _client->stateToString());
+
+    _client->close();
+
+    return;
+  }
+
+  _armTimer();
 }
 
 /////////////////////////////////////////////////
@@ -331,6 +550,10 @@ void AsyncWebServerRequest::_onAck(size_t len, uint32_t time)
 {
   AWS_LOGDEBUG3("onAck: len =", len, ", time =", time);
 
+#if AWS_METRICS
+  _metricsBytesOut += len;
+#endif
+
   if (_response != NULL)
   {
     if (!_response->_finished())
@@ -344,8 +567,27 @@ void AsyncWebServerRequest::_onAck(size_t len, uint32_t time)
       delete r;
     }
   }
+
+  // Don't leave a finished deferred response for the next poll when an ACK comes first
+  if (_deferState.load() == AWS_DEFER_DONE)
+  {
+    _completeDeferred();
+  }
+}
+
+/////////////////////////////////////////////////
+
+#if AWS_METRICS
+
+// From the responses' _ack(), as some of them close the connection, or hand it over and delete the request, right after
+void AsyncWebServerRequest::_metricsLastAck()
+{
+  if (_handler)
+    _handler->metrics().timeToLastAck.observe(micros() - _metricsStart);
 }
 
+#endif
+
 /////////////////////////////////////////////////
 
 void AsyncWebServerRequest::_onError(int8_t error)
@@ -380,14 +622,106 @@ void AsyncWebServerRequest::_onDisconnect()
     _onDisconnectfn();
   }
 
+  // A deferred handler still queued or running keeps the request, its worker deletes it
+  if (_cancelDeferred())
+  {
+    _timer.cancel();
+    _client = NULL;
+
+    return;
+  }
+
   _server->_handleDisconnect(this);
 }
 
 /////////////////////////////////////////////////
 
+bool AsyncWebServerRequest::defer(ArDeferredHandlerFunction fn)
+{
+  if (!fn || _response || _deferState.load() != AWS_DEFER_NONE)
+    return false;
+
+  if (!_server->workers().started() && !_server->workers().begin())
+    return false;
+
+  _deferredFn = fn;
+  _deferState.store(AWS_DEFER_QUEUED);
+
+  // The worker may take longer than the idle timeout, the response is what counts now
+  _timer.cancel();
+
+  if (!_server->workers().submit(this))
+  {
+    AWS_LOGDEBUG1("defer: worker queue full, pending =", _server->workers().pending());
+
+    _deferState.store(AWS_DEFER_NONE);
+    _deferredFn = nullptr;
+    _armTimer();
+
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// Worker task. Only the side that loses the race against _onDisconnect() deletes the request
+void AsyncWebServerRequest::_runDeferred()
+{
+  uint8_t expected = AWS_DEFER_QUEUED;
+
+  if (_deferState.compare_exchange_strong(expected, AWS_DEFER_RUNNING))
+  {
+    _deferredFn(this);
+
+    expected = AWS_DEFER_RUNNING;
+
+    if (_deferState.compare_exchange_strong(expected, AWS_DEFER_DONE))
+      return;
+  }
+
+  // The client disconnected meanwhile
+  delete this;
+}
+
+/////////////////////////////////////////////////
+
+// AsyncTCP task, once the worker is done
+void AsyncWebServerRequest::_completeDeferred()
+{
+  AsyncWebServerResponse * response = _deferredResponse;
+
+  _deferredResponse = NULL;
+  _deferredFn = nullptr;
+  _deferState.store(AWS_DEFER_NONE);
+
+  if (response)
+    send(response);
+  else
+    send(500);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebServerRequest::_cancelDeferred()
+{
+  uint8_t state = _deferState.load();
+
+  while ( (state == AWS_DEFER_QUEUED || state == AWS_DEFER_RUNNING) &&
+          !_deferState.compare_exchange_weak(state, AWS_DEFER_CANCELLED) );
+
+  return (state == AWS_DEFER_QUEUED || state == AWS_DEFER_RUNNING);
+}
+
+/////////////////////////////////////////////////
+
 void AsyncWebServerRequest::_addParam(AsyncWebParameter *p)
 {
+  // Query params come first
+  _materializeParams();
   _params.add(p);
+  _indexParam(p);
 }
 
 /////////////////////////////////////////////////
@@ -399,31 +733,68 @@ void AsyncWebServerRequest::_addPathParam(const char *p)
 
 /////////////////////////////////////////////////
 
+// Only keeps the query string, see _materializeParams()
 void AsyncWebServerRequest::_addGetParams(const String& params)
 {
-  size_t start = 0;
+  if (!params.length())
+    return;
+
+  AsyncWebRawQuery * q = (AsyncWebRawQuery *) _arena.alloc(sizeof(AsyncWebRawQuery));
+
+  if (!q)
+    return;
+
+  q->next = NULL;
+  q->len = params.length();
+  q->data = _arena.copy(params.c_str(), q->len);
+
+  if (!q->data)
+    return;
+
+  *_rawQueryTail = q;
+  _rawQueryTail = &q->next;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_parseGetParams(char *p, size_t len) const
+{
+  char * end = p + len;
 
-  while (start < params.length())
+  while (p < end)
   {
-    int end = params.indexOf('&', start);
+    char * amp = (char *) memchr(p, '&', end - p);
+    char * stop = amp ? amp : end;
+    char * equal = (char *) memchr(p, '=', stop - p);
+    char * value = equal ? (equal + 1) : stop;
 
-    if (end < 0)
-      end = params.length();
+    size_t nameLen = urlDecodeInPlace(p, (equal ? equal : stop) - p);
+    size_t valueLen = urlDecodeInPlace(value, stop - value);
 
-    int equal = params.indexOf('=', start);
+    AsyncWebParameter * param = new AsyncWebParameter(sliceToString(p, nameLen), sliceToString(value, valueLen));
 
-    if (equal < 0 || equal > end)
-      equal = end;
+    _params.add(param);
+    _indexParam(param);
 
-    String name = params.substring(start, equal);
-    String value = equal + 1 < end ? params.substring(equal + 1, end) : String();
-    _addParam(new AsyncWebParameter(urlDecode(name), urlDecode(value)));
-    start = end + 1;
+    p = stop + 1;
   }
 }
 
 /////////////////////////////////////////////////
 
+void AsyncWebServerRequest::_materializeParams() const
+{
+  AsyncWebRawQuery * q = _rawQuery;
+
+  _rawQuery = NULL;
+  _rawQueryTail = &_rawQuery;
+
+  for (; q; q = q->next)
+    _parseGetParams(q->data, q->len);
+}
+
+/////////////////////////////////////////////////
+
 bool AsyncWebServerRequest::_parseReqHead()
 {
   // Split the head into method, url and version
@@ -471,45 +842,39 @@ bool AsyncWebServerRequest::_parseReqHead()
     u = u.substring(0, index);
   }
 
-  _url = urlDecode(u);
+  char * url = _arena.copy(u.c_str(), u.length());
+
+  if (url)
+    _url = sliceToString(url, urlDecodeInPlace(url, u.length()));
+
   _addGetParams(g);
 
   if (!_temp.startsWith("HTTP/1.0"))
     _version = 1;
 
-  _temp = String();
+  // Keeps the line buffer for the headers
+  _temp.remove(0);
 
   return true;
 }
 
 /////////////////////////////////////////////////
 
-bool strContains(String src, String find, bool mindcase = true)
+static inline bool headerNameIs(const char * name, size_t len, const char * known)
 {
-  int pos = 0, i = 0;
-  const int slen = src.length();
-  const int flen = find.length();
+  return (strlen(known) == len) && !strncasecmp(name, known, len);
+}
 
-  if (slen < flen)
-    return false;
+/////////////////////////////////////////////////
 
-  while (pos <= (slen - flen))
-  {
-    for (i = 0; i < flen; i++)
-    {
-      if (mindcase)
-      {
-        if (src[pos + i] != find[i])
-          i = flen + 1; // no match
-      }
-      else if (tolower(src[pos + i]) != tolower(find[i]))
-        i = flen + 1; // no match
-    }
+static bool containsIgnoreCase(const char * str, size_t len, const char * find)
+{
+  size_t flen = strlen(find);
 
-    if (i == flen)
+  for (size_t pos = 0; pos + flen <= len; pos++)
+  {
+    if (!strncasecmp(str + pos, find, flen))
       return true;
-
-    pos++;
   }
 
   return false;
@@ -517,111 +882,496 @@ bool strContains(String src, String find, bool mindcase = true)
 
 /////////////////////////////////////////////////
 
-bool AsyncWebServerRequest::_parseReqHeader()
+// Value of cookie name in a Cookie header, NULL if it isn't there
+static const char * findCookie(const char * cookies, const char * name)
 {
-  int index = _temp.indexOf(':');
+  size_t len = strlen(name);
 
-  if (index)
+  for (const char * c = cookies; c && *c; )
   {
-    String name = _temp.substring(0, index);
-    String value = _temp.substring(index + 2);
+    while (*c == ' ')
+      c++;
 
-    if (name.equalsIgnoreCase("Host"))
-    {
-      _host = value;
-    }
-    else if (name.equalsIgnoreCase("Content-Type"))
-    {
-      _contentType = value.substring(0, value.indexOf(';'));
+    if (!strncmp(c, name, len) && c[len] == '=')
+      return c + len + 1;
 
-      if (value.startsWith("multipart/"))
-      {
-        _boundary = value.substring(value.indexOf('=') + 1);
-        _boundary.replace("\"", "");
-        _isMultipart = true;
-      }
-    }
-    else if (name.equalsIgnoreCase("Content-Length"))
-    {
-      _contentLength = atoi(value.c_str());
-    }
-    else if (name.equalsIgnoreCase("Expect") && value == "100-continue")
-    {
-      _expectingContinue = true;
-    }
-    else if (name.equalsIgnoreCase("Authorization"))
-    {
-      if (value.length() > 5 && value.substring(0, 5).equalsIgnoreCase("Basic"))
-      {
-        _authorization = value.substring(6);
-      }
-      else if (value.length() > 6 && value.substring(0, 6).equalsIgnoreCase("Digest"))
-      {
-        _isDigest = true;
-        _authorization = value.substring(7);
-      }
-    }
-    else
-    {
-      if (name.equalsIgnoreCase("Upgrade") && value.equalsIgnoreCase("websocket"))
-      {
-        // WebSocket request can be uniquely identified by header: [Upgrade: websocket]
-        _reqconntype = RCT_WS;
-      }
-      else
-      {
-        if (name.equalsIgnoreCase("Accept") && strContains(value, "text/event-stream", false))
-        {
-          // WebEvent request can be uniquely identified by header:  [Accept: text/event-stream]
-          _reqconntype = RCT_EVENT;
-        }
-      }
-    }
+    c = strchr(c, ';');
 
-    _headers.add(new AsyncWebHeader(name, value));
+    if (c)
+      c++;
   }
 
-  _temp = String();
-
-  return true;
+  return NULL;
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebServerRequest::_parsePlainPostChar(uint8_t data)
+// Picks out the headers the server itself needs, and keeps the line in the arena for the accessors
+bool AsyncWebServerRequest::_parseReqHeader()
 {
-  if (data && (char)data != '&')
-    _temp += (char)data;
+  int index = _temp.indexOf(':');
 
-  if (!data || (char)data == '&' || _parsedLength == _contentLength)
+  if (index > 0)
   {
-    String name = "body";
-    String value = _temp;
+    const char * name = _temp.c_str();
+    size_t nameLen = index;
+    size_t valueStart = ((size_t) index + 2 < _temp.length()) ? (index + 2) : _temp.length();
+    const char * value = name + valueStart;
+    size_t valueLen = _temp.length() - valueStart;
+
+    AwsHeaderId id = awsHeaderId(name, nameLen);
 
-    if (!_temp.startsWith("{") && !_temp.startsWith("[") && _temp.indexOf('=') > 0)
+    switch (id)
     {
-      name = _temp.substring(0, _temp.indexOf('='));
-      value = _temp.substring(_temp.indexOf('=') + 1);
-    }
+      case AWS_HDR_HOST:
+        _host = value;
+        break;
 
-    _addParam(new AsyncWebParameter(urlDecode(name), urlDecode(value), true));
-    _temp = String();
-  }
-}
+      case AWS_HDR_CONTENT_TYPE:
+      {
+        String v(value);
 
-/////////////////////////////////////////////////
+        _contentType = v.substring(0, v.indexOf(';'));
 
-void AsyncWebServerRequest::_handleUploadByte(uint8_t data, bool last)
-{
-  _itemBuffer[_itemBufferIndex++] = data;
+        if (v.startsWith("multipart/"))
+        {
+          _boundary = v.substring(v.indexOf('=') + 1);
+          _boundary.replace("\"", "");
+          _isMultipart = true;
+        }
 
-  if (last || _itemBufferIndex == 1460)
-  {
-    //check if authenticated before calling the upload
-    if (_handler)
-      _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, false);
+        break;
+      }
 
-    _itemBufferIndex = 0;
+      case AWS_HDR_CONTENT_LENGTH:
+        _contentLength = atoi(value);
+        break;
+
+      case AWS_HDR_EXPECT:
+        if (!strcmp(value, "100-continue"))
+          _expectingContinue = true;
+
+        break;
+
+      case AWS_HDR_AUTHORIZATION:
+        if (valueLen > 5 && !strncasecmp(value, "Basic", 5))
+        {
+          _authorization = value + 6;
+        }
+        else if (valueLen > 6 && !strncasecmp(value, "Digest", 6))
+        {
+          _isDigest = true;
+          _authorization = value + 7;
+        }
+        else if (valueLen > 6 && !strncasecmp(value, "Bearer", 6))
+        {
+          _token = value + 7;
+        }
+
+        break;
+
+      case AWS_HDR_COOKIE:
+        // A bearer header wins over the cookie
+        if (!_token.length())
+        {
+          const char * c = findCookie(value, AWS_TOKEN_COOKIE);
+
+          if (c)
+          {
+            const char * end = strchr(c, ';');
+
+            _token = sliceToString(c, end ? (size_t) (end - c) : strlen(c));
+          }
+        }
+
+        break;
+
+      case AWS_HDR_UPGRADE:
+        // WebSocket request can be uniquely identified by header: [Upgrade: websocket]
+        if (!strcasecmp(value, "websocket"))
+          _reqconntype = RCT_WS;
+
+        break;
+
+      case AWS_HDR_ACCEPT:
+        // WebEvent request can be uniquely identified by header:  [Accept: text/event-stream]
+        if (containsIgnoreCase(value, valueLen, "text/event-stream"))
+          _reqconntype = RCT_EVENT;
+
+        break;
+
+      default:
+        break;
+    }
+
+    AsyncWebRawHeader * h = (AsyncWebRawHeader *) _arena.alloc(sizeof(AsyncWebRawHeader));
+    char * copy = h ? _arena.alloc(nameLen + valueLen + 2) : NULL;
+
+    if (copy)
+    {
+      memcpy(copy, name, nameLen);
+      copy[nameLen] = 0;
+      memcpy(copy + nameLen + 1, value, valueLen + 1);
+
+      h->next = NULL;
+      h->name = copy;
+      h->nameLen = nameLen;
+      h->value = copy + nameLen + 1;
+      h->id = id;
+      h->hash = (id == AWS_HDR_UNKNOWN) ? awsHeaderHash(name, nameLen) : 0;
+
+      if (id != AWS_HDR_UNKNOWN)
+        _presentHeaders |= AWS_HDR_BIT(id);
+
+      *_rawHeadersTail = h;
+      _rawHeadersTail = &h->next;
+    }
+  }
+
+  // Keeps the line buffer for the next header
+  _temp.remove(0);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebServerRequest::_isInterestingHeader(AwsHeaderId id, const char *name, size_t len) const
+{
+  if (!_headersFiltered || _interestingAny)
+    return true;
+
+  if (id != AWS_HDR_UNKNOWN)
+    return (_interestingMask & AWS_HDR_BIT(id)) != 0;
+
+  for (const auto& s : _interestingHeaders)
+  {
+    if (headerNameIs(name, len, s.c_str()))
+      return true;
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_materializeHeaders() const
+{
+  AsyncWebRawHeader * h = _rawHeaders;
+
+  _rawHeaders = NULL;
+  _rawHeadersTail = &_rawHeaders;
+
+  if (!h)
+    return;
+
+  for (; h; h = h->next)
+  {
+    if (_isInterestingHeader(h->id, h->name, h->nameLen))
+      _headers.add(new AsyncWebHeader(h->name, h->value));
+  }
+
+  _headerIndex = NULL;
+}
+
+/////////////////////////////////////////////////
+
+// Well-known names get a slot per id, the others a small open addressing table keyed by awsHeaderHash()
+const AsyncWebHeaderIndex * AsyncWebServerRequest::_indexHeaders() const
+{
+  _materializeHeaders();
+
+  if (_headerIndex)
+    return _headerIndex;
+
+  AsyncWebHeaderIndex * index = (AsyncWebHeaderIndex *) _arena.alloc(sizeof(AsyncWebHeaderIndex));
+
+  if (!index)
+    return NULL;
+
+  memset(index, 0, sizeof(AsyncWebHeaderIndex));
+
+  size_t others = 0;
+
+  for (const auto& h : _headers)
+  {
+    const String& n = h->name();
+    AwsHeaderId id = awsHeaderId(n.c_str(), n.length());
+
+    if (id == AWS_HDR_UNKNOWN)
+      others++;
+    else if (!index->known[id])
+      index->known[id] = h;
+  }
+
+  if (others)
+  {
+    size_t slots = 4;
+
+    while (slots < others * 2)
+      slots <<= 1;
+
+    index->slots = (AsyncWebHeaderSlot *) _arena.alloc(slots * sizeof(AsyncWebHeaderSlot));
+
+    if (!index->slots)
+      return NULL;
+
+    memset(index->slots, 0, slots * sizeof(AsyncWebHeaderSlot));
+    index->slotMask = slots - 1;
+
+    for (const auto& h : _headers)
+    {
+      const String& n = h->name();
+
+      if (awsHeaderId(n.c_str(), n.length()) != AWS_HDR_UNKNOWN)
+        continue;
+
+      uint32_t hash = awsHeaderHash(n.c_str(), n.length());
+      size_t i = hash & index->slotMask;
+
+      // The first header with a given name wins, as with a list scan
+      while (index->slots[i].header && !(index->slots[i].hash == hash && index->slots[i].header->name().equalsIgnoreCase(n)))
+        i = (i + 1) & index->slotMask;
+
+      if (!index->slots[i].header)
+      {
+        index->slots[i].hash = hash;
+        index->slots[i].header = h;
+      }
+    }
+  }
+
+  _headerIndex = index;
+
+  return index;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebHeader * AsyncWebServerRequest::_findHeader(const AsyncWebName& name) const
+{
+  const AsyncWebHeaderIndex * index = _indexHeaders();
+
+  if (!index)
+    return NULL;
+
+  AwsHeaderId id = name.headerId();
+
+  if (id != AWS_HDR_UNKNOWN)
+    return index->known[id];
+
+  if (!index->slots)
+    return NULL;
+
+  uint32_t hash = name.hash();
+
+  for (size_t i = hash & index->slotMask; index->slots[i].header; i = (i + 1) & index->slotMask)
+  {
+    const AsyncWebHeaderSlot& slot = index->slots[i];
+
+    if (slot.hash == hash && name.equalsIgnoreCase(slot.header->name().c_str(), slot.header->name().length()))
+      return slot.header;
+  }
+
+  return NULL;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebServerRequest::_hasHeader(const AsyncWebName& name) const
+{
+  AwsHeaderId id = name.headerId();
+
+  if (id != AWS_HDR_UNKNOWN)
+    return hasHeader(id);
+
+  // Answered from the raw lines, without materializing them
+  for (const AsyncWebRawHeader * h = _rawHeaders; h; h = h->next)
+  {
+    if (h->hash == name.hash() && name.equalsIgnoreCase(h->name, h->nameLen) && _isInterestingHeader(h->id, h->name, h->nameLen))
+    {
+      return true;
+    }
+  }
+
+  if (_rawHeaders)
+  {
+    for (const auto& h : _headers)
+    {
+      if (name.equalsIgnoreCase(h->name().c_str(), h->name().length()))
+        return true;
+    }
+
+    return false;
+  }
+
+  return (_findHeader(name) != NULL);
+}
+
+/////////////////////////////////////////////////
+
+// Params keep their order, so the first match wins. anyKind ignores the post / file filters, as arg() does
+AsyncWebParameter * AsyncWebServerRequest::_findParam(const AsyncWebName& name, bool post, bool file, bool anyKind) const
+{
+  _materializeParams();
+
+  if (!_paramIndex && (_params.length() >= AWS_PARAM_INDEX_MIN))
+    _indexParams();
+
+  if (_paramIndex)
+  {
+    uint32_t hash = name.hash();
+    size_t mask = _paramIndex->slotMask;
+
+    // Linear probing never reorders equal names, so they are met in request order
+    for (size_t i = hash & mask; _paramIndex->slots[i].param; i = (i + 1) & mask)
+    {
+      if (_paramIndex->slots[i].hash != hash)
+        continue;
+
+      AsyncWebParameter * p = _paramIndex->slots[i].param;
+
+      if (name.equals(p->name(), p->hash()) && (anyKind || (p->isPost() == post && p->isFile() == file)))
+        return p;
+    }
+
+    return nullptr;
+  }
+
+  for (const auto& p : _params)
+  {
+    if (name.equals(p->name(), p->hash()) && (anyKind || (p->isPost() == post && p->isFile() == file)))
+    {
+      return p;
+    }
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_indexParams() const
+{
+  size_t slots = 16;
+
+  while (slots < _params.length() * 2)
+    slots <<= 1;
+
+  AsyncWebParamIndex * index = (AsyncWebParamIndex *) _arena.alloc(sizeof(AsyncWebParamIndex));
+  AsyncWebParamSlot * table = index ? (AsyncWebParamSlot *) _arena.alloc(slots * sizeof(AsyncWebParamSlot)) : NULL;
+
+  // Out of memory : keep scanning the list
+  if (!table)
+    return;
+
+  memset(table, 0, slots * sizeof(AsyncWebParamSlot));
+
+  index->slots = table;
+  index->slotMask = slots - 1;
+  index->count = 0;
+
+  _paramIndex = index;
+
+  for (const auto& p : _params)
+    _indexParam(p);
+}
+
+/////////////////////////////////////////////////
+
+// Keeps an existing index up to date as body params arrive. Past half full it is dropped, and rebuilt larger on the next lookup
+void AsyncWebServerRequest::_indexParam(AsyncWebParameter * p) const
+{
+  if (!_paramIndex)
+    return;
+
+  if ((_paramIndex->count + 1) * 2 > (_paramIndex->slotMask + 1))
+  {
+    _paramIndex = NULL;
+
+    return;
+  }
+
+  size_t mask = _paramIndex->slotMask;
+  size_t i = p->hash() & mask;
+
+  while (_paramIndex->slots[i].param)
+    i = (i + 1) & mask;
+
+  _paramIndex->slots[i].hash = p->hash();
+  _paramIndex->slots[i].param = p;
+  _paramIndex->count++;
+}
+
+/////////////////////////////////////////////////
+
+// Accumulates the current name=value pair in the arena, splitting on '&' a slice at a time
+void AsyncWebServerRequest::_parsePlainPost(char *data, size_t len)
+{
+  char * p = data;
+  char * end = data + len;
+
+  while (p < end)
+  {
+    char * amp = (char *) memchr(p, '&', end - p);
+    char * stop = amp ? amp : end;
+
+    _arena.append(p, stop - p);
+    _parsedLength += stop - p;
+    p = stop;
+
+    if (amp)
+    {
+      _parsedLength++;
+      p++;
+
+      _addPlainPostPair();
+    }
+  }
+
+  // A trailing '&' already closed the last pair
+  if (len && _parsedLength == _contentLength && data[len - 1] != '&')
+    _addPlainPostPair();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_addPlainPostPair()
+{
+  size_t len;
+  char * pair = _arena.finish(&len);
+  char * equal = NULL;
+
+  if (len && pair[0] != '{' && pair[0] != '[')
+    equal = (char *) memchr(pair, '=', len);
+
+  if (equal && equal > pair)
+  {
+    char * value = equal + 1;
+    size_t nameLen = urlDecodeInPlace(pair, equal - pair);
+    size_t valueLen = urlDecodeInPlace(value, pair + len - value);
+
+    _addParam(new AsyncWebParameter(sliceToString(pair, nameLen), sliceToString(value, valueLen), true));
+  }
+  else
+  {
+    _addParam(new AsyncWebParameter("body", sliceToString(pair, urlDecodeInPlace(pair, len)), true));
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::_handleUploadByte(uint8_t data, bool last)
+{
+  _itemBuffer[_itemBufferIndex++] = data;
+
+  if (last || _itemBufferIndex == 1460)
+  {
+    //check if authenticated before calling the upload
+    if (_handler)
+      _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, false);
+
+    _itemBufferIndex = 0;
   }
 }
 
@@ -644,6 +1394,34 @@ enum
 
 /////////////////////////////////////////////////
 
+// A part's closing delimiter matched : store the form value or finish the upload
+void AsyncWebServerRequest::_handleUploadEnd()
+{
+  _multiParseState = DASH3_OR_RETURN2;
+
+  if (!_itemIsFile)
+  {
+    _addParam(new AsyncWebParameter(_itemName, _itemValue, true));
+  }
+  else
+  {
+    if (_itemSize)
+    {
+      //check if authenticated before calling the upload
+      if (_handler)
+        _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, true);
+
+      _itemBufferIndex = 0;
+      _addParam(new AsyncWebParameter(_itemName, _itemFilename, true, true, _itemSize));
+    }
+
+    free(_itemBuffer);
+    _itemBuffer = NULL;
+  }
+}
+
+/////////////////////////////////////////////////
+
 void AsyncWebServerRequest::_parseMultipartPostByte(uint8_t data, bool last)
 {
 #define itemWriteByte(b)        do { _itemSize++; if(_itemIsFile) _handleUploadByte(b, last); else _itemValue+=(char)(b); } while(0)
@@ -846,94 +1624,230 @@ void AsyncWebServerRequest::_parseMultipartPostByte(uint8_t data, bool last)
     }
     else if (_boundaryPosition == _boundary.length() - 1)
     {
-      _multiParseState = DASH3_OR_RETURN2;
+      _handleUploadEnd();
+    }
+    else
+    {
+      _boundaryPosition++;
+    }
+  }
+  else if (_multiParseState == DASH3_OR_RETURN2)
+  {
+    if (data == '-' && (_contentLength - _parsedLength - 4) != 0)
+    {
+      AWS_LOGDEBUG1("ERROR: The parser got to the end of the POST but is expecting more bytes =",
+                    (_contentLength - _parsedLength - 4));
+      AWS_LOGDEBUG("Drop an issue so we can have more info on the matter!");
 
-      if (!_itemIsFile)
-      {
-        _addParam(new AsyncWebParameter(_itemName, _itemValue, true));
-      }
-      else
-      {
-        if (_itemSize)
-        {
-          //check if authenticated before calling the upload
-          if (_handler)
-            _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, true);
+      _contentLength = _parsedLength + 4;//lets close the request gracefully
+    }
 
-          _itemBufferIndex = 0;
-          _addParam(new AsyncWebParameter(_itemName, _itemFilename, true, true, _itemSize));
-        }
+    if (data == '\r')
+    {
+      _multiParseState = EXPECT_FEED2;
+    }
+    else if (data == '-' && _contentLength == (_parsedLength + 4))
+    {
+      _multiParseState = PARSING_FINISHED;
+    }
+    else
+    {
+      _multiParseState = WAIT_FOR_RETURN1;
+      itemWriteByte('\r');
+      itemWriteByte('\n');
+      itemWriteByte('-');
+      itemWriteByte('-');
+
+      uint8_t i;
+
+      for (i = 0; i < _boundary.length(); i++)
+        itemWriteByte(_boundary.c_str()[i]);
+
+      _parseMultipartPostByte(data, last);
+    }
+  }
+  else if (_multiParseState == EXPECT_FEED2)
+  {
+    if (data == '\n')
+    {
+      _multiParseState = PARSE_HEADERS;
+      _itemIsFile = false;
+    }
+    else
+    {
+      _multiParseState = WAIT_FOR_RETURN1;
+      itemWriteByte('\r');
+      itemWriteByte('\n');
+      itemWriteByte('-');
+      itemWriteByte('-');
+
+      uint8_t i;
+
+      for (i = 0; i < _boundary.length(); i++)
+        itemWriteByte(_boundary.c_str()[i]);
+
+      itemWriteByte('\r');
+
+      _parseMultipartPostByte(data, last);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Part bodies are searched for the delimiter a chunk at a time, boundary lines and part headers
+// still go through _parseMultipartPostByte()
+void AsyncWebServerRequest::_parseMultipart(uint8_t *data, size_t len)
+{
+  size_t i = 0;
+
+  while (i < len)
+  {
+    if (_multiParseState == WAIT_FOR_RETURN1 && _parsedLength)
+    {
+      size_t used = _parseMultipartData(data + i, len - i);
+
+      i += used;
+      _parsedLength += used;
+    }
+    else
+    {
+      _parseMultipartPostByte(data[i], i == len - 1);
+      _parsedLength++;
+      i++;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Hands len bytes of part body to the form value or, as one slice, to the upload handler
+void AsyncWebServerRequest::_writeMultipartData(uint8_t *data, size_t len)
+{
+  if (!len)
+    return;
+
+  if (!_itemIsFile)
+  {
+    _itemValue.concat((const char *) data, len);
+  }
+  else if (_handler)
+  {
+    // Bytes left over by the byte-wise path go first
+    if (_itemBufferIndex)
+    {
+      _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, false);
+      _itemBufferIndex = 0;
+    }
+
+    _handler->handleUpload(this, _itemFilename, _itemSize, data, len, false);
+  }
+
+  _itemSize += len;
+}
+
+/////////////////////////////////////////////////
+
+// Consumes part body up to and including the "\r\n--boundary" delimiter, or all of data.
+// _delimiterMatched carries a delimiter prefix seen at the end of the previous chunk
+size_t AsyncWebServerRequest::_parseMultipartData(uint8_t *data, size_t len)
+{
+  if (!_delimiterSkip)
+  {
+    _delimiterSkip = (uint8_t *) malloc(256);
+
+    if (!_delimiterSkip)
+    {
+      _multiParseState = PARSE_ERROR;
+
+      return len;
+    }
+
+    _delimiter = "\r\n--";
+    _delimiter += _boundary;
+
+    // A smaller shift than Horspool's is always safe, so long delimiters are clamped
+    size_t m = _delimiter.length();
 
-        free(_itemBuffer);
-        _itemBuffer = NULL;
-      }
+    memset(_delimiterSkip, (m < 255) ? m : 255, 256);
 
-    }
-    else
-    {
-      _boundaryPosition++;
-    }
+    for (size_t i = 0; i < m - 1; i++)
+      _delimiterSkip[(uint8_t) _delimiter[i]] = (m - 1 - i < 255) ? (m - 1 - i) : 255;
+
+    _delimiterMatched = 0;
   }
-  else if (_multiParseState == DASH3_OR_RETURN2)
+
+  const uint8_t *delim = (const uint8_t *) _delimiter.c_str();
+  size_t m = _delimiter.length();
+
+  // Delimiter split across chunks
+  while (_delimiterMatched)
   {
-    if (data == '-' && (_contentLength - _parsedLength - 4) != 0)
+    size_t need = m - _delimiterMatched;
+    size_t n = (len < need) ? len : need;
+
+    if (!memcmp(data, delim + _delimiterMatched, n))
     {
-      AWS_LOGDEBUG1("ERROR: The parser got to the end of the POST but is expecting more bytes =",
-                    (_contentLength - _parsedLength - 4));
-      AWS_LOGDEBUG("Drop an issue so we can have more info on the matter!");
+      if (n < need)
+      {
+        _delimiterMatched += n;
 
-      _contentLength = _parsedLength + 4;//lets close the request gracefully
-    }
+        return len;
+      }
 
-    if (data == '\r')
-    {
-      _multiParseState = EXPECT_FEED2;
-    }
-    else if (data == '-' && _contentLength == (_parsedLength + 4))
-    {
-      _multiParseState = PARSING_FINISHED;
+      _delimiterMatched = 0;
+      _handleUploadEnd();
+
+      return n;
     }
-    else
-    {
-      _multiParseState = WAIT_FOR_RETURN1;
-      itemWriteByte('\r');
-      itemWriteByte('\n');
-      itemWriteByte('-');
-      itemWriteByte('-');
 
-      uint8_t i;
+    // Not a delimiter after all. Its bytes are data, up to a suffix that may start one again
+    size_t j = 1;
 
-      for (i = 0; i < _boundary.length(); i++)
-        itemWriteByte(_boundary.c_str()[i]);
+    while (j < _delimiterMatched && memcmp(delim + j, delim, _delimiterMatched - j))
+      j++;
 
-      _parseMultipartPostByte(data, last);
+    for (size_t k = 0; k < j; k++)
+    {
+      _itemSize++;
+
+      if (_itemIsFile)
+        _handleUploadByte(delim[k], false);
+      else
+        _itemValue += (char) delim[k];
     }
+
+    _delimiterMatched -= j;
   }
-  else if (_multiParseState == EXPECT_FEED2)
+
+  // Boyer-Moore-Horspool
+  size_t pos = 0;
+
+  while (pos + m <= len)
   {
-    if (data == '\n')
+    uint8_t c = data[pos + m - 1];
+
+    if (c == delim[m - 1] && !memcmp(data + pos, delim, m - 1))
     {
-      _multiParseState = PARSE_HEADERS;
-      _itemIsFile = false;
+      _writeMultipartData(data, pos);
+      _handleUploadEnd();
+
+      return pos + m;
     }
-    else
-    {
-      _multiParseState = WAIT_FOR_RETURN1;
-      itemWriteByte('\r');
-      itemWriteByte('\n');
-      itemWriteByte('-');
-      itemWriteByte('-');
 
-      uint8_t i;
+    pos += _delimiterSkip[c];
+  }
 
-      for (i = 0; i < _boundary.length(); i++)
-        itemWriteByte(_boundary.c_str()[i]);
+  // No delimiter. Keep back the longest tail that could be the start of one
+  size_t tail = (len > m - 1) ? (len - (m - 1)) : 0;
 
-      itemWriteByte('\r');
+  while (tail < len && memcmp(data + tail, delim, len - tail))
+    tail++;
 
-      _parseMultipartPostByte(data, last);
-    }
-  }
+  _writeMultipartData(data, tail);
+  _delimiterMatched = len - tail;
+
+  return len;
 }
 
 /////////////////////////////////////////////////
@@ -963,6 +1877,13 @@ void AsyncWebServerRequest::_parseLine()
       //end of headers
       _server->_rewriteRequest(this);
       _server->_attachHandler(this);
+
+#if AWS_METRICS
+
+      if (_handler)
+        _handler->metrics().timeToHandler.observe(micros() - _metricsStart);
+
+#endif
       _removeNotInterestingHeaders();
 
       if (_expectingContinue)
@@ -996,6 +1917,8 @@ void AsyncWebServerRequest::_parseLine()
 
 size_t AsyncWebServerRequest::headers() const
 {
+  _materializeHeaders();
+
   return _headers.length();
 }
 
@@ -1003,90 +1926,58 @@ size_t AsyncWebServerRequest::headers() const
 
 bool AsyncWebServerRequest::hasHeader(const String& name) const
 {
-  for (const auto& h : _headers)
-  {
-    if (h->name().equalsIgnoreCase(name))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return _hasHeader(name);
 }
 
 /////////////////////////////////////////////////
 
-bool AsyncWebServerRequest::hasHeader(const __FlashStringHelper * data) const
+bool AsyncWebServerRequest::hasHeader(AwsHeaderId id) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = 0;
+  if (id >= AWS_HDR_COUNT)
+    return false;
 
-  while (1)
-  {
-    if (pgm_read_byte(p + n) == 0)
-      break;
+  return (_presentHeaders & AWS_HDR_BIT(id)) && _isInterestingHeader(id, NULL, 0);
+}
 
-    n += 1;
-  }
+/////////////////////////////////////////////////
 
-  char * name = (char*) malloc(n + 1);
-  name[n] = 0;
+bool AsyncWebServerRequest::hasHeader(const __FlashStringHelper * data) const
+{
+  return _hasHeader(data);
+}
 
-  if (name)
-  {
-    for (size_t b = 0; b < n; b++)
-      name[b] = pgm_read_byte(p++);
+/////////////////////////////////////////////////
 
-    bool result = hasHeader( String(name) );
-    free(name);
-    return result;
-  }
-  else
-  {
-    return false;
-  }
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const
+{
+  return _findHeader(name);
 }
 
 /////////////////////////////////////////////////
 
-AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const
+AsyncWebHeader* AsyncWebServerRequest::getHeader(AwsHeaderId id) const
 {
-  for (const auto& h : _headers)
-  {
-    if (h->name().equalsIgnoreCase(name))
-    {
-      return h;
-    }
-  }
+  if (id >= AWS_HDR_COUNT)
+    return nullptr;
 
-  return nullptr;
+  const AsyncWebHeaderIndex * index = _indexHeaders();
+
+  return (index ? index->known[id] : nullptr);
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebHeader* AsyncWebServerRequest::getHeader(const __FlashStringHelper * data) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-  char * name = (char*) malloc(n + 1);
-
-  if (name)
-  {
-    strcpy_P(name, p);
-    AsyncWebHeader* result = getHeader( String(name));
-    free(name);
-    return result;
-  }
-  else
-  {
-    return nullptr;
-  }
+  return _findHeader(data);
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebHeader* AsyncWebServerRequest::getHeader(size_t num) const
 {
+  _materializeHeaders();
+
   auto header = _headers.nth(num);
 
   return (header ? *header : nullptr);
@@ -1096,6 +1987,8 @@ AsyncWebHeader* AsyncWebServerRequest::getHeader(size_t num) const
 
 size_t AsyncWebServerRequest::params() const
 {
+  _materializeParams();
+
   return _params.length();
 }
 
@@ -1103,82 +1996,36 @@ size_t AsyncWebServerRequest::params() const
 
 bool AsyncWebServerRequest::hasParam(const String& name, bool post, bool file) const
 {
-  for (const auto& p : _params)
-  {
-    if (p->name() == name && p->isPost() == post && p->isFile() == file)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return (_findParam(name, post, file, false) != nullptr);
 }
 
 /////////////////////////////////////////////////
 
 bool AsyncWebServerRequest::hasParam(const __FlashStringHelper * data, bool post, bool file) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-
-  char * name = (char*) malloc(n + 1);
-  name[n] = 0;
-
-  if (name)
-  {
-    strcpy_P(name, p);
-    bool result = hasParam( name, post, file);
-    free(name);
-
-    return result;
-  }
-  else
-  {
-    return false;
-  }
+  return (_findParam(data, post, file, false) != nullptr);
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const
 {
-  for (const auto& p : _params)
-  {
-    if (p->name() == name && p->isPost() == post && p->isFile() == file)
-    {
-      return p;
-    }
-  }
-
-  return nullptr;
+  return _findParam(name, post, file, false);
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebParameter* AsyncWebServerRequest::getParam(const __FlashStringHelper * data, bool post, bool file) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-  char * name = (char*) malloc(n + 1);
-
-  if (name)
-  {
-    strcpy_P(name, p);
-    AsyncWebParameter* result = getParam(name, post, file);
-    free(name);
-
-    return result;
-  }
-  else
-  {
-    return nullptr;
-  }
+  return _findParam(data, post, file, false);
 }
 
 /////////////////////////////////////////////////
 
 AsyncWebParameter* AsyncWebServerRequest::getParam(size_t num) const
 {
+  _materializeParams();
+
   auto param = _params.nth(num);
 
   return (param ? *param : nullptr);
@@ -1186,9 +2033,26 @@ AsyncWebParameter* AsyncWebServerRequest::getParam(size_t num) const
 
 /////////////////////////////////////////////////
 
-void AsyncWebServerRequest::addInterestingHeader(const String& name)
+void AsyncWebServerRequest::addInterestingHeader(AwsHeaderId id)
+{
+  if (id == AWS_HDR_ANY)
+    _interestingAny = true;
+  else if (id < AWS_HDR_COUNT)
+    _interestingMask |= AWS_HDR_BIT(id);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebServerRequest::addInterestingHeader(const char * name)
 {
-  if (!_interestingHeaders.containsIgnoreCase(name))
+  size_t len = strlen(name);
+  AwsHeaderId id = awsHeaderId(name, len);
+
+  if (id != AWS_HDR_UNKNOWN)
+    addInterestingHeader(id);
+  else if (!strcasecmp(name, "ANY"))
+    addInterestingHeader(AWS_HDR_ANY);
+  else if (!_interestingHeaders.containsIgnoreCase(name))
     _interestingHeaders.add(name);
 }
 
@@ -1196,6 +2060,17 @@ void AsyncWebServerRequest::addInterestingHeader(const String& name)
 
 void AsyncWebServerRequest::send(AsyncWebServerResponse *response)
 {
+  // From the deferred handler : only keep the response, the AsyncTCP task sends it
+  if (_deferState.load() >= AWS_DEFER_RUNNING)
+  {
+    if (_deferredResponse == NULL)
+      _deferredResponse = response;
+    else if (response)
+      delete response;
+
+    return;
+  }
+
   _response = response;
 
   if (_response == NULL)
@@ -1215,6 +2090,17 @@ void AsyncWebServerRequest::send(AsyncWebServerResponse *response)
   }
   else
   {
+#if AWS_METRICS
+
+    if (_handler)
+    {
+      _metricsCode = _response->code();
+      _handler->metrics().timeToFirstByte.observe(micros() - _metricsStart);
+    }
+
+#endif
+
+    _timer.cancel();
     _client->setRxTimeout(0);
     _response->_respond(this);
   }
@@ -1415,8 +2301,51 @@ void AsyncWebServerRequest::redirect(const String& url)
 
 /////////////////////////////////////////////////
 
+static uint64_t authKey(const char * username, const char * password, const char * realm, bool passwordIsHash)
+{
+  const char * parts[3] = { username, password, realm };
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    for (const char * c = parts[i]; c && *c; c++)
+      hash = (hash ^ (uint8_t) *c) * 1099511628211ULL;
+
+    hash = (hash ^ 0xFF) * 1099511628211ULL;
+  }
+
+  hash = (hash ^ (passwordIsHash ? 1 : 0)) * 1099511628211ULL;
+
+  return hash | 1;
+}
+
+/////////////////////////////////////////////////
+
 bool AsyncWebServerRequest::authenticate(const char * username, const char * password, const char * realm,
                                          bool passwordIsHash)
+{
+  uint64_t key = authKey(username, password, realm, passwordIsHash);
+
+  if (key == _authPassed)
+    return true;
+
+  if (key == _authFailed)
+    return false;
+
+  bool result = _authenticate(username, password, realm, passwordIsHash);
+
+  if (result)
+    _authPassed = key;
+  else
+    _authFailed = key;
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebServerRequest::_authenticate(const char * username, const char * password, const char * realm,
+                                          bool passwordIsHash)
 {
   AWS_LOGDEBUG1("AsyncWebServerRequest::authenticate: auth-len =", _authorization.length());
 
@@ -1427,7 +2356,7 @@ bool AsyncWebServerRequest::authenticate(const char * username, const char * pas
       AWS_LOGDEBUG("AsyncWebServerRequest::authenticate: _isDigest");
 
       return checkDigestAuthentication(_authorization.c_str(), methodToString(), username, password, realm, passwordIsHash,
-                                       NULL, NULL, NULL);
+                                       NULL, NULL, NULL, &_authStale);
     }
     else if (!passwordIsHash)
     {
@@ -1455,6 +2384,16 @@ bool AsyncWebServerRequest::authenticate(const char * hash)
   if (!_authorization.length() || hash == NULL)
     return false;
 
+  uint64_t key = authKey(NULL, hash, NULL, true);
+
+  if (key == _authPassed)
+    return true;
+
+  if (key == _authFailed)
+    return false;
+
+  bool result = false;
+
   if (_isDigest)
   {
     String hStr = String(hash);
@@ -1473,11 +2412,27 @@ bool AsyncWebServerRequest::authenticate(const char * hash)
     String realm = hStr.substring(0, separator);
     hStr = hStr.substring(separator + 1);
 
-    return checkDigestAuthentication(_authorization.c_str(), methodToString(), username.c_str(), hStr.c_str(),
-                                     realm.c_str(), true, NULL, NULL, NULL);
+    result = checkDigestAuthentication(_authorization.c_str(), methodToString(), username.c_str(), hStr.c_str(),
+                                       realm.c_str(), true, NULL, NULL, NULL, &_authStale);
+  }
+  else
+  {
+    result = _authorization.equals(hash);
   }
 
-  return (_authorization.equals(hash));
+  if (result)
+    _authPassed = key;
+  else
+    _authFailed = key;
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebServerRequest::authenticate(const AsyncWebTokenAuth& auth, String * subject)
+{
+  return _token.length() && auth.verify(_token, subject);
 }
 
 /////////////////////////////////////////////////
@@ -1499,8 +2454,9 @@ void AsyncWebServerRequest::requestAuthentication(const char * realm, bool isDig
   }
   else
   {
+    // stale : the credentials were right but the nonce expired, the browser retries without prompting
     String header = "Digest ";
-    header.concat(requestDigestAuthentication(realm));
+    header.concat(requestDigestAuthentication(realm, _authStale));
     r->addHeader("WWW-Authenticate", header);
   }
 
@@ -1511,74 +2467,32 @@ void AsyncWebServerRequest::requestAuthentication(const char * realm, bool isDig
 
 bool AsyncWebServerRequest::hasArg(const char* name) const
 {
-  for (const auto& arg : _params)
-  {
-    if (arg->name() == name)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return (_findParam(name, false, false, true) != nullptr);
 }
 
 /////////////////////////////////////////////////
 
 bool AsyncWebServerRequest::hasArg(const __FlashStringHelper * data) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-  char * name = (char*) malloc(n + 1);
-
-  if (name)
-  {
-    strcpy_P(name, p);
-    bool result = hasArg( name );
-    free(name);
-
-    return result;
-  }
-  else
-  {
-    return false;
-  }
+  return (_findParam(data, false, false, true) != nullptr);
 }
 
 /////////////////////////////////////////////////
 
 const String& AsyncWebServerRequest::arg(const String& name) const
 {
-  for (const auto& arg : _params)
-  {
-    if (arg->name() == name)
-    {
-      return arg->value();
-    }
-  }
+  AsyncWebParameter* p = _findParam(name, false, false, true);
 
-  return SharedEmptyString;
+  return (p ? p->value() : SharedEmptyString);
 }
 
 /////////////////////////////////////////////////
 
 const String& AsyncWebServerRequest::arg(const __FlashStringHelper * data) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-  char * name = (char*) malloc(n + 1);
+  AsyncWebParameter* p = _findParam(data, false, false, true);
 
-  if (name)
-  {
-    strcpy_P(name, p);
-    const String & result = arg( String(name) );
-    free(name);
-
-    return result;
-  }
-  else
-  {
-    return SharedEmptyString;
-  }
+  return (p ? p->value() : SharedEmptyString);
 }
 
 /////////////////////////////////////////////////
@@ -1608,7 +2522,7 @@ const String& AsyncWebServerRequest::pathArg(size_t i) const
 
 const String& AsyncWebServerRequest::header(const char* name) const
 {
-  AsyncWebHeader* h = getHeader(String(name));
+  AsyncWebHeader* h = _findHeader(name);
 
   return (h ? h->value() : SharedEmptyString);
 }
@@ -1617,23 +2531,20 @@ const String& AsyncWebServerRequest::header(const char* name) const
 
 const String& AsyncWebServerRequest::header(const __FlashStringHelper * data) const
 {
-  PGM_P p = reinterpret_cast<PGM_P>(data);
-  size_t n = strlen_P(p);
-  char * name = (char*) malloc(n + 1);
+  AsyncWebHeader* h = _findHeader(data);
 
-  if (name)
-  {
-    strcpy_P(name, p);
-    const String & result = header( (const char *)name );
-    free(name);
+  return (h ? h->value() : SharedEmptyString);
+}
+
+/////////////////////////////////////////////////
+
+const String& AsyncWebServerRequest::header(AwsHeaderId id) const
+{
+  AsyncWebHeader* h = getHeader(id);
+
+  return (h ? h->value() : SharedEmptyString);
+}
 
-    return result;
-  }
-  else
-  {
-    return SharedEmptyString;
-  }
-};
 /////////////////////////////////////////////////
 
 const String& AsyncWebServerRequest::header(size_t i) const
@@ -1656,34 +2567,17 @@ const String& AsyncWebServerRequest::headerName(size_t i) const
 
 String AsyncWebServerRequest::urlDecode(const String& text) const
 {
-  char temp[] = "0x00";
-  unsigned int len = text.length();
-  unsigned int i = 0;
-  String decoded = String();
-  decoded.reserve(len); // Allocate the string internal buffer - never longer from source text
+  size_t len = text.length();
+  char * buf = (char *) malloc(len + 1);
 
-  while (i < len)
-  {
-    char decodedChar;
-    char encodedChar = text.charAt(i++);
+  if (!buf)
+    return String();
 
-    if ((encodedChar == '%') && (i + 1 < len))
-    {
-      temp[2] = text.charAt(i++);
-      temp[3] = text.charAt(i++);
-      decodedChar = strtol(temp, NULL, 16);
-    }
-    else if (encodedChar == '+')
-    {
-      decodedChar = ' ';
-    }
-    else
-    {
-      decodedChar = encodedChar;  // normal ascii char
-    }
+  memcpy(buf, text.c_str(), len);
 
-    decoded.concat(decodedChar);
-  }
+  String decoded = sliceToString(buf, urlDecodeInPlace(buf, len));
+
+  free(buf);
 
   return decoded;
 }
@@ -622,6 +622,10 @@ size_t AsyncBasicResponse::_ack(AsyncWebServerRequest *request, size_t len, uint
     if (_ackedLength >= _writtenLength)
     {
       _state = RESPONSE_END;
+
+#if AWS_METRICS
+      request->_metricsLastAck();
+#endif
     }
   }
 
@@ -803,6 +807,12 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, u
     {
       _state = RESPONSE_END;
 
+#if AWS_METRICS
+      // Without Content-Length the end is the close below, before the last bytes are ACKed : not observed
+      if (_ackedLength >= _writtenLength)
+        request->_metricsLastAck();
+#endif
+
       if (!_chunked && !_sendContentLength)
         request->client()->close(true);
     }
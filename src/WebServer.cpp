@@ -66,7 +66,9 @@ AsyncWebServer::AsyncWebServer(uint16_t port)
 _handlers(LinkedList<AsyncWebHandler*>([](AsyncWebHandler* h)
 {
   delete h;
-}))
+})),
+_requestIdleTimeout(AWS_REQUEST_IDLE_TIMEOUT),
+_requestHeaderTimeout(AWS_REQUEST_HEADER_TIMEOUT)
 {
   _catchAllHandler = new AsyncCallbackWebHandler();
 
@@ -78,7 +80,7 @@ _handlers(LinkedList<AsyncWebHandler*>([](AsyncWebHandler* h)
     if (c == NULL)
       return;
 
-    c->setRxTimeout(3);
+    // Request timeouts run on the server timer wheel instead of per-client rx timeouts
     AsyncWebServerRequest *r = new AsyncWebServerRequest((AsyncWebServer*)s, c);
 
     if (r == NULL)
@@ -207,7 +209,7 @@ void AsyncWebServer::_attachHandler(AsyncWebServerRequest *request)
     }
   }
 
-  request->addInterestingHeader("ANY");
+  request->addInterestingHeader(AWS_HDR_ANY);
   request->setHandler(_catchAllHandler);
 }
 